@@ -0,0 +1,52 @@
+#include "boot.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#include <stdio.h>
+
+static const char* const phase_names[BOOT_PHASES] = {"display", "tflm", "selftest", "usb"};
+
+typedef struct {
+    uint32_t begin_us;
+    uint32_t end_us;
+    bool done;
+} boot_stamp_t;
+
+static volatile boot_stamp_t stamps[BOOT_PHASES];
+static uint32_t ready_us = 0;
+
+void boot_begin(boot_phase_t phase) {
+    stamps[phase].begin_us = time_us_32();
+}
+
+void boot_end(boot_phase_t phase) {
+    stamps[phase].end_us = time_us_32();
+    stamps[phase].done = true;
+}
+
+void boot_ready(void) {
+    ready_us = time_us_32();
+}
+
+bool boot_wait_usb(void) {
+    boot_begin(BOOT_USB);
+    // Prazos contados do reset: o tempo do display e do TFLM já conta como espera
+    while (!stdio_usb_connected()) {
+        uint32_t now = time_us_32();
+        if (!tud_mounted() && now >= CNN_BOOT_ENUM_MS * 1000u) break;  // sem host
+        if (now >= CNN_BOOT_USB_WAIT_MS * 1000u) break;                // host sem terminal aberto
+        sleep_ms(1);
+    }
+    boot_end(BOOT_USB);
+    return stdio_usb_connected();
+}
+
+void boot_report(void) {
+    for (int i = 0; i < BOOT_PHASES; i++) {
+        if (!stamps[i].done) continue;  // fase desligada no build
+        printf("BOOT,%s,%lu,%lu,%lu\n", phase_names[i], (unsigned long)stamps[i].begin_us,
+               (unsigned long)stamps[i].end_us, (unsigned long)(stamps[i].end_us - stamps[i].begin_us));
+    }
+    printf("BOOT,READY,%lu\n", (unsigned long)ready_us);
+    printf("BOOT,END\n");
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Boot rápido: o display é configurado no core1 (CNN_BOOT_PARALLEL) enquanto o
+// core0 monta o interpretador, e a espera pela serial USB só acontece se tiver
+// host: sem enumeração em CNN_BOOT_ENUM_MS (alimentado por bateria/fonte) segue
+// direto; enumerado, espera o terminal abrir até CNN_BOOT_USB_WAIT_MS desde o reset.
+//
+// Cada fase grava início e fim (us desde o reset, o timer começa em 0) e o
+// relatório sai no boot e no $BOOT:
+//   BOOT,<fase>,<inicio_us>,<fim_us>,<duracao_us>   display, tflm, selftest, usb
+//   BOOT,READY,<us>                                  primeira amostra aceita a partir daqui
+//   BOOT,END
+
+#ifndef CNN_BOOT_PARALLEL
+#define CNN_BOOT_PARALLEL 1
+#endif
+#ifndef CNN_BOOT_ENUM_MS
+#define CNN_BOOT_ENUM_MS 500  // host presente enumera bem antes disso
+#endif
+#ifndef CNN_BOOT_USB_WAIT_MS
+#define CNN_BOOT_USB_WAIT_MS 2000  // o sleep fixo de antes
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BOOT_DISPLAY,   // I2C, config do SSD1306 e tela de espera (core1 com CNN_BOOT_PARALLEL)
+    BOOT_TFLM,      // tflm_init
+    BOOT_SELFTEST,  // autoteste de boot
+    BOOT_USB,       // espera pelo terminal (o que sobrar depois das outras)
+    BOOT_PHASES,
+} boot_phase_t;
+
+// Podem ser chamadas de qualquer núcleo, uma fase por núcleo
+void boot_begin(boot_phase_t phase);
+void boot_end(boot_phase_t phase);
+void boot_ready(void);
+
+// Espera o terminal abrir (ver acima); true se tem alguém lendo a serial
+bool boot_wait_usb(void);
+
+void boot_report(void);
+
+#ifdef __cplusplus
+}
+#endif
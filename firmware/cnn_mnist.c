@@ -4,216 +4,888 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
-#include <math.h>
 #include "tflm_wrapper.h"
+#include "serial_proto.h"
+#include "mnist_codec.h"
+#include "eval_stats.h"
+#include "telemetry.h"
+#include "mem_pool.h"
+#include "mnist_kernels.h"
+#include "display_task.h"
+#include "model_store.h"
+#include "selftest.h"
+#include "task_sched.h"
+#include "boot.h"
+#include "tusb.h"
+#if CNN_DUAL_CORE
+#include "dual_core.h"
+#endif
+#if CNN_DUAL_CORE || CNN_BOOT_PARALLEL
+#include "pico/multicore.h"
+#endif
 #include "ssd1306.h"
 #include "font.h"
 
 #define MNIST_SIZE 784// 28x28 pixels -> tamanhop da iomagem
-#define CSV_BUFFER_SIZE 8192 // buffer pra receber linha CSV via serial
+#define RX_LINE_MAX 8192 // linha maior que isso é lixo (CSV completo tem ~3200 chars)
+#define RX_TIMEOUT_US 3000000  // linha parada por 3 s é abandonada
+#define RX_POLL_US 1000        // serial olhada pelo menos a cada 1 ms (sem callback de chegada)
+#define CORE1_POLL_US 50       // cabeça da fila no core1: confere de novo nesse intervalo
+#define OUT_QUEUE_LEN (PROTO_WINDOW + 2)  // respostas esperando a serial (uma por slot e folga pra NAK/W)
+#define OUT_LINE_MAX 48        // maior linha de resposta ("R,...") com folga
+#define OUT_POLL_US 1000       // USB sem espaço: tenta de novo nesse intervalo
+
+// Tarefas do loop principal, em ordem de prioridade (ver task_sched.h)
+enum { TASK_RX, TASK_PARSE, TASK_OUT, TASK_DISPLAY, TASK_INFER, TASK_TIMEOUT };
+#define RX_CMD_MAX 576   // comandos "$..." são curtos; o maior é "$MODEL DATA" com 256 bytes em hex
 ssd1306_t display;
-static char csv_buffer[CSV_BUFFER_SIZE];
-static int csv_pos = 0;
 static absolute_time_t last_byte_time; // usado pra detectar timeout
-// Retorna o índice do maior valor no array (classe predita)
-static int argmax_i8(const int8_t* v, int n) {
-    int best = 0;
-    int8_t bestv = v[0];
-    for (int i = 1; i < n; i++) {
-        if (v[i] > bestv) {
-            bestv = v[i];
-            best = i;
-        }
-    }
-    return best;
-}
-
-
+static uint32_t line_start_us;         // chegada do primeiro byte da linha (telemetria rx)
 
-// Converte float [0-1] pra int8 quantizado usando scale e zero_point
-static int8_t quantize_f32_to_i8(float x, float scale, int zp) {
-    float q = (x / scale) + (float)zp;  // formula: q = x/scale + zero_point
-    if (q > 127.0f) q = 127.0f;         // clamp no range int8
-    if (q < -128.0f) q = -128.0f;
-    return (int8_t)q;
-}
-// Converte logits int8 pra probabilidades usando softmax
-// probs[] vai ter os valores em porcentagem (0-100)
-void softmax_i8_to_probs(const int8_t* logits, float scale, int zero_point, float* probs, int n) {
-    float dequant[10];
-    float max_val = -1e9f;
-    // Primeiro dequantiza os logits int8 -> float
-    for (int i = 0; i < n; i++) {
-        dequant[i] = scale * ((float)logits[i] - (float)zero_point);  // x = scale * (q - zp)
-        if (dequant[i] > max_val) max_val = dequant[i];  // acha o max pra estabilidade numérica
-    }
-    // Softmax: exp(x - max) / sum(exp(x - max))
-    // Subtrair max evita overflow no exp()
-    float sum = 0.0f;
-    for (int i = 0; i < n; i++) {
-        dequant[i] = expf(dequant[i] - max_val);
-        sum += dequant[i];
-    }
-    // Normaliza e converte pra porcentagem
-    for (int i = 0; i < n; i++) {
-        probs[i] = (dequant[i] / sum) * 100.0f;
-    }
-}
-// Faz parse de uma linha CSV no formato: label,pixel1,pixel2,...,pixel784
-// Retorna 0 se OK, -1 se erro
-static int parse_csv_line(const char* line, uint8_t* label, uint8_t* pixels) {
-    const char* ptr = line;
-    char num_buf[8];
-    int num_pos = 0;
-    int field_count = 0;
-    // Pula espaços e ignora linhas vazias/comentários
-    while (*ptr == ' ' || *ptr == '\t') ptr++;
-    if (*ptr == '\0' || *ptr == '\n' || *ptr == '#') return -1;
-    // Lê cada campo separado por vírgula
-    while (*ptr != '\0' && *ptr != '\n' && field_count <= MNIST_SIZE) {
-        // Lê os dígitos do número atual
-        num_pos = 0;
-        while (*ptr >= '0' && *ptr <= '9' && num_pos < sizeof(num_buf)-1) {
-            num_buf[num_pos++] = *ptr++;
-        }
-        num_buf[num_pos] = '\0';
-        
-        if (num_pos > 0) {
-            int value = atoi(num_buf);
-            
-            if (field_count == 0) {
-                *label = (uint8_t)(value & 0xFF);  // primeiro campo é o label
-            } else if (field_count <= MNIST_SIZE) {
-                // Campos 1-784 são os pixels, clamp em [0-255]
-                if (value < 0) value = 0;
-                if (value > 255) value = 255;
-                pixels[field_count - 1] = (uint8_t)value;
-            }
-            
-            field_count++;
-        }
-        // Pula vírgulas e espaços
-        while (*ptr == ',' || *ptr == ' ' || *ptr == '\t') ptr++;
-    }
-    return (field_count == 785) ? 0 : -1;  // precisa ter exatamente 1 label + 784 pixels
-}
-// Mostra no display OLED o top 3 de predições com probabilidades
-void show_results(const float* probs, uint8_t true_label) {
-    typedef struct {
-        int digit;
-        float prob;
-    } prediction_t;
-    // Copia probabilidades pra struct que vai ser ordenada
-    prediction_t preds[10];
-    for (int i = 0; i < 10; i++) {
-        preds[i].digit = i;
-        preds[i].prob = probs[i];
-    }
-    // Ordena decrescente por probabilidade (bubble sort)
-    for (int i = 0; i < 9; i++) {
-        for (int j = 0; j < 9 - i; j++) {
-            if (preds[j].prob < preds[j+1].prob) {
-                prediction_t temp = preds[j];
-                preds[j] = preds[j+1];
-                preds[j+1] = temp;
-            }
-        }
-    }
-    ssd1306_fill(&display, false);    // Monta tela do display
-    char line[24];
-    snprintf(line, sizeof(line), "REAL: %d", true_label);    // Linha 0: label verdadeiro
-    ssd1306_draw_string(&display, line, 0, 0, false);
-    // Top 3 predições com probabilidades
-    snprintf(line, sizeof(line), "%d %.1f%%", preds[0].digit, preds[0].prob);
-    ssd1306_draw_string(&display, line, 0, 14, false);
-    snprintf(line, sizeof(line), "%d %.1f%%", preds[1].digit, preds[1].prob);
-    ssd1306_draw_string(&display, line, 0, 26, false);
-    snprintf(line, sizeof(line), "%d %.1f%%", preds[2].digit, preds[2].prob);
-    ssd1306_draw_string(&display, line, 0, 38, false);
-    //Última linha: mostra se acertou ou errou
-    bool correct = (preds[0].digit == true_label);
-    snprintf(line, sizeof(line), "PRED:%d %s", preds[0].digit, correct ? "OK!" : "ERR");
-    ssd1306_draw_string(&display, line, 0, 52, false);
-    
-    ssd1306_send_data(&display);  // envia buffer pro display
-}
-// Executa a inferência completa: quantiza input, roda modelo, calcula probs e exibe
-static void run_inference(uint8_t label, const uint8_t* pixels) {
+// Amostra recebida aguardando inferência (cada slot é um crédito da janela)
+// Os pixels já chegam quantizados: direto no tensor de entrada quando a fila está
+// vazia, ou numa das reservas quando o host manda mais de um frame em sequência
+typedef struct {
+    uint32_t id;
+    bool framed;       // veio com id pelo protocolo -> resposta compacta R/N
+    uint8_t label;
+    uint16_t rx_bytes;   // tamanho do frame recebido
+    uint32_t decode_us;  // decodificador durante a recepção + fechamento do frame depois do '\n'
+    int8_t* input;       // tensor de entrada ou reserva, int8[784]
+#if CNN_DUAL_CORE
+    uint8_t run;         // SLOT_QUEUED -> SLOT_CORE1 (só reservas) -> SLOT_DONE
+    int8_t rc;           // código do invoke
+    int8_t logits[10];   // guardados até a vez do slot responder
+#endif
+} sample_slot_t;
+#if CNN_DUAL_CORE
+enum { SLOT_QUEUED, SLOT_CORE1, SLOT_DONE };
+#endif
+static sample_slot_t slots[PROTO_WINDOW];
+static int8_t (*spare_inputs)[MNIST_SIZE];  // PROTO_WINDOW-1 reservas do mem_pool (o tensor é o slot que falta)
+static uint8_t spare_used = 0;     // bitmask das reservas ocupadas (PROTO_WINDOW <= 9)
+static int8_t* input_tensor;       // buffer do tensor de entrada (tflm_input_ptr)
+static int8_t input_lut[256];      // pixel 0..255 -> int8 quantizado
+static eval_stats_t eval;          // matriz de confusão do modo avaliação
+static bool eval_mode = false;     // modo avaliação: acumula sem imprimir por amostra
+static int slot_head = 0;   // próximo slot a ser processado
+static int slot_count = 0;  // slots ocupados
+// Pós-processamento de uma amostra: softmax, argmax, saída verbosa e publicação pro display
+// Retorna a classe predita
+static int finish_inference(uint8_t label, const int8_t* input, const int8_t* logits,
+                            bool verbose, float* confidence) {
     // Variáveis static pra não precisar buscar a cada inferência
-    static int8_t *in = NULL, *out = NULL;
-    static float in_scale, out_scale;
-    static int in_zp, out_zp;
+    static float out_scale;
+    static int out_zp;
     static bool initialized = false;
-    // Na primeira execução, pega os ponteiros e parâmetros de quantização do modelo
+    // Na primeira execução, pega os parâmetros de quantização do modelo
     if (!initialized) {
-        int in_bytes, out_bytes;
-        in = tflm_input_ptr(&in_bytes);    // ponteiro pro tensor de entrada
-        out = tflm_output_ptr(&out_bytes); // ponteiro pro tensor de saída
-        in_scale = tflm_input_scale();
-        in_zp = tflm_input_zero_point();
         out_scale = tflm_output_scale();
         out_zp = tflm_output_zero_point();
-        printf("\nTFLM config:\n");
-        printf("  Input: scale=%.6f, zero_point=%d\n", in_scale, in_zp);
-        printf("  Output: scale=%.6f, zero_point=%d\n\n", out_scale, out_zp);
         initialized = true;
     }
-    printf("\n--- Nova inferencia ---\n");
-    printf("Label real: %d\n", label);
-    printf("Primeiros pixels: %d,%d,%d,%d,%d\n", 
-           pixels[0], pixels[1], pixels[2], pixels[3], pixels[4]);
-    // Normaliza pixels [0-255] -> [0-1] e quantiza pra int8
-    for (int i = 0; i < MNIST_SIZE; i++) {
-        float normalized = (float)pixels[i] / 255.0f;
-        in[i] = quantize_f32_to_i8(normalized, in_scale, in_zp);
+    static bool config_printed = false;
+    if (verbose && !config_printed) {
+        printf("\nTFLM config:\n");
+        printf("  Input: scale=%.6f, zero_point=%d\n", tflm_input_scale(), tflm_input_zero_point());
+        printf("  Output: scale=%.6f, zero_point=%d\n", out_scale, out_zp);
+        printf("  Batch: %d\n\n", tflm_batch_size());
+        config_printed = true;
+    }
+    if (verbose) {
+        printf("\n--- Nova inferencia ---\n");
+        printf("Label real: %d\n", label);
+        printf("Primeiros valores int8: %d,%d,%d,%d,%d\n", 
+               input[0], input[1], input[2], input[3], input[4]);
+    }
+    // Converte saída int8 pra probabilidades em %
+    TELEM_BEGIN(TELEM_SOFTMAX, t_softmax);
+    float probs[10];
+    softmax_i8_to_probs(logits, out_scale, out_zp, probs, 10);
+    // Calcula predição (classe com maior probabilidade)
+    int pred = argmax_i8(logits, 10);
+    TELEM_END(TELEM_SOFTMAX, t_softmax);
+    TELEM_COUNT(TELEM_SAMPLES);
+    bool correct = (pred == label);
+    if (verbose) {
+        printf("Invoke OK\n\n");
+        // Exibe todas as probabilidades na serial
+        printf("Probabilidades:\n");
+        for (int i = 0; i < 10; i++) {
+            printf("  %d: %6.2f%%", i, probs[i]);
+            if (i == label) printf(" <- real");  // marca qual é o label verdadeiro
+            printf("\n");
+        }
+        printf("\nResultado: pred=%d real=%d %s (confianca: %.1f%%)\n\n", 
+               pred, label, correct ? "OK" : "ERRO", probs[pred]);
+    }
+    display_post(probs, label, pred, time_us_32());  // o display pega o mais recente no ritmo dele
+    sched_signal(TASK_DISPLAY);
+    if (confidence) *confidence = probs[pred];
+    return pred;
+}
+#if CNN_BATCH == 1 && !CNN_DUAL_CORE
+// Executa a inferência completa: roda modelo sobre a entrada já quantizada, calcula probs e exibe
+// Retorna a classe predita (ou -1 se o invoke falhar); verbose=false só publica pro display
+static int run_inference(uint8_t label, const int8_t* input, bool verbose, float* confidence) {
+    // Amostra numa reserva: copia pro tensor (a quantização já foi feita na recepção)
+    if (input != input_tensor) {
+        TELEM_BEGIN(TELEM_QUANT, t_quant);
+        int8_t* in = tflm_input_acquire();
+        if (in) memcpy(in, input, MNIST_SIZE);
+        TELEM_END(TELEM_QUANT, t_quant);
+        if (!in) {
+            printf("ERRO tensor de entrada ocupado\n");
+            return -1;
+        }
     }
     // Roda a inferência
-    int rc = tflm_invoke();
+    TELEM_BEGIN(TELEM_INVOKE, t_invoke);
+    int rc = tflm_input_commit_invoke();
+    TELEM_END(TELEM_INVOKE, t_invoke);
     if (rc != 0) {
         printf("ERRO tflm_invoke: %d\n", rc);
+        return -1;
+    }
+    return finish_inference(label, input, tflm_output_ptr(NULL), verbose, confidence);
+}
+#endif
+// Slots livres na janela = créditos anunciados ao host
+static int free_slots(void) {
+    return PROTO_WINDOW - slot_count;
+}
+// Respostas do protocolo (R/N/W) na ordem em que foram decididas. A inferência e o
+// parse só enfileiram; a tarefa de saída escreve uma por vez quando o USB tem
+// espaço, então um host que lê devagar só segura o invoke depois de encher a fila
+typedef struct {
+    char kind;           // 'R', 'N' ou 'W'
+    bool has_id;
+    uint32_t id;
+    const char* reason;  // NAK
+    uint8_t pred;
+    uint8_t label;
+    uint16_t conf_x10;
+    uint16_t rx_bytes;
+    uint32_t decode_us;
+} out_msg_t;
+static out_msg_t out_queue[OUT_QUEUE_LEN];
+static int out_head = 0;
+static int out_count = 0;
+// O crédito vai com o valor da hora do envio (os slots já liberados contam)
+static void out_send_one(void) {
+    out_msg_t* m = &out_queue[out_head];
+    out_head = (out_head + 1) % OUT_QUEUE_LEN;
+    out_count--;
+    if (m->kind == 'R') {
+        proto_send_result(m->id, m->pred, m->label, m->conf_x10, m->rx_bytes, m->decode_us, free_slots());
+    } else if (m->kind == 'N') {
+        proto_send_nak(m->has_id ? &m->id : NULL, m->reason, free_slots());
+    } else {
+        proto_send_window(free_slots());
+    }
+    if (slot_count > 0) sched_signal(TASK_INFER);  // pode ter parado com a fila cheia
+}
+// Fila cheia (só pelo claim_input ou comando): escreve a mais antiga na hora
+static out_msg_t* out_push(char kind) {
+    if (out_count == OUT_QUEUE_LEN) out_send_one();
+    out_msg_t* m = &out_queue[(out_head + out_count) % OUT_QUEUE_LEN];
+    memset(m, 0, sizeof(*m));
+    m->kind = kind;
+    out_count++;
+    sched_signal(TASK_OUT);
+    return m;
+}
+static void out_nak(const uint32_t* id, const char* reason) {
+    out_msg_t* m = out_push('N');
+    m->has_id = id != NULL;
+    m->id = id ? *id : 0;
+    m->reason = reason;
+}
+// Antes de qualquer printf fora da fila (comandos), pra não passar na frente
+static void out_flush(void) {
+    while (out_count > 0) out_send_one();
+}
+// Cabe uma linha inteira no buffer do CDC (sem terminal aberto o printf descarta)
+static bool out_room(void) {
+    return !tud_cdc_connected() || tud_cdc_write_available() >= OUT_LINE_MAX;
+}
+// Devolve o buffer de uma amostra (tensor ou reserva)
+static void release_input(int8_t* input) {
+    if (!input) return;
+    if (input == input_tensor) {
+        tflm_input_release();
+    } else {
+        spare_used &= (uint8_t)~(1u << ((input - spare_inputs[0]) / MNIST_SIZE));
+    }
+}
+// Tira a amostra mais antiga da fila, devolve o buffer dela e responde (R/N) se veio pelo protocolo
+static void complete_head(int pred, float conf) {
+    sample_slot_t* s = &slots[slot_head];
+    if (s->input != input_tensor) release_input(s->input);  // o tensor já voltou a ficar livre no invoke
+    else if (pred < 0) tflm_input_release();
+    slot_head = (slot_head + 1) % PROTO_WINDOW;
+    slot_count--;
+    if (eval_mode && pred >= 0) eval_add(&eval, s->label, pred, time_us_32());
+    if (s->framed) {
+        if (pred < 0) {
+            out_nak(&s->id, "INVOKE");
+        } else {
+            out_msg_t* m = out_push('R');
+            m->id = s->id;
+            m->pred = (uint8_t)pred;
+            m->label = s->label;
+            m->conf_x10 = (uint16_t)(conf * 10.0f + 0.5f);
+            m->rx_bytes = s->rx_bytes;
+            m->decode_us = s->decode_us;
+        }
+    }
+}
+#if CNN_DUAL_CORE
+static sample_slot_t* slot_at(int k) {
+    return &slots[(slot_head + k) % PROTO_WINDOW];
+}
+// Resultado do core1 chegou: o invoke dele entra na telemetria pelo core0
+static void collect_core1(void) {
+    int rc;
+    uint32_t invoke_us;
+    if (!dual_core_poll(&rc, &invoke_us)) return;
+#if CNN_TELEMETRY
+    telem_record(TELEM_INVOKE, invoke_us);
+#endif
+    if (rc != 0) printf("ERRO tflm_invoke (core1): %d\n", rc);
+    for (int k = 0; k < slot_count; k++) {
+        sample_slot_t* s = slot_at(k);
+        if (s->run == SLOT_CORE1) {
+            s->rc = (int8_t)rc;
+            s->run = SLOT_DONE;
+            return;
+        }
+    }
+}
+// Dois interpretadores, um por núcleo: o core0 fica com a amostra mais antiga da
+// fila e o core1, se estiver livre, com a seguinte (o tensor da instância 0 nunca
+// vai pro core1, mas ele só é usado com a fila vazia, então é sempre a cabeça)
+// As respostas saem na ordem de chegada: um slot pronto espera a cabeça terminar
+static void process_dual(void) {
+    collect_core1();
+    sample_slot_t* mine = NULL;
+    for (int k = 0; k < slot_count; k++) {
+        sample_slot_t* s = slot_at(k);
+        if (s->run != SLOT_QUEUED) continue;
+        if (!mine) {
+            mine = s;
+        } else if (dual_core_busy()) {
+            break;  // core1 ainda com a anterior: só a cabeça roda agora
+        } else if (s->input != input_tensor) {
+            if (dual_core_submit(s->input, s->logits)) s->run = SLOT_CORE1;
+            break;
+        }
+    }
+    if (mine) {
+        TELEM_BEGIN(TELEM_INVOKE, t_invoke);
+        int rc = tflm_invoke_instance(0, mine->input, mine->logits);
+        TELEM_END(TELEM_INVOKE, t_invoke);
+        if (rc != 0) printf("ERRO tflm_invoke: %d\n", rc);
+        mine->rc = (int8_t)rc;
+        mine->run = SLOT_DONE;
+        collect_core1();
+    }
+    // Sem nada pra rodar e a cabeça no core1: volta pro loop, a serial segue sendo lida
+    while (slot_count > 0 && slots[slot_head].run == SLOT_DONE) {
+        sample_slot_t* s = &slots[slot_head];
+        float conf = 0.0f;
+        int pred = -1;
+        if (s->rc == 0) {
+            pred = finish_inference(s->label, s->input, s->logits, !s->framed && !eval_mode, &conf);
+        }
+        complete_head(pred, conf);
+    }
+}
+#endif
+#if CNN_BATCH > 1
+// Junta até CNN_BATCH amostras da fila num invoke só e responde cada uma em ordem
+// O custo do invoke é o mesmo com o batch cheio ou não (dimensão fixa no modelo),
+// então com a serial ociosa roda o que tiver na fila em vez de esperar completar
+static void process_batch(void) {
+    int n = slot_count < CNN_BATCH ? slot_count : CNN_BATCH;
+    const int8_t* inputs[CNN_BATCH];
+    int8_t* outputs[CNN_BATCH];
+    int8_t logits[CNN_BATCH][10];
+    for (int k = 0; k < n; k++) {
+        inputs[k] = slots[(slot_head + k) % PROTO_WINDOW].input;
+        outputs[k] = logits[k];
+    }
+    TELEM_BEGIN(TELEM_INVOKE, t_invoke);
+    int rc = tflm_invoke_batch(inputs, outputs, n);
+    TELEM_END(TELEM_INVOKE, t_invoke);
+    if (rc != 0) printf("ERRO tflm_invoke_batch: %d\n", rc);
+    for (int k = 0; k < n; k++) {
+        sample_slot_t* s = &slots[slot_head];
+        float conf = 0.0f;
+        int pred = -1;
+        if (rc == 0) {
+            pred = finish_inference(s->label, s->input, logits[k], !s->framed && !eval_mode, &conf);
+        }
+        complete_head(pred, conf);
+    }
+}
+#endif
+// Processa a amostra mais antiga da fila (ou o próximo batch, se o modelo tiver batch > 1)
+static void process_next_slot(void) {
+#if CNN_BATCH > 1
+    process_batch();
+#elif CNN_DUAL_CORE
+    process_dual();
+#else
+    sample_slot_t* s = &slots[slot_head];
+    float conf = 0.0f;
+    int pred = run_inference(s->label, s->input, !s->framed && !eval_mode, &conf);
+    complete_head(pred, conf);
+#endif
+}
+// Responde tudo o que está na fila antes de um comando que imprime ou mexe no modelo
+static void drain_slots(void) {
+    while (slot_count > 0) process_next_slot();
+    out_flush();
+}
+// Escolhe onde a próxima amostra vai ser escrita: direto no tensor se a fila está
+// vazia, senão numa reserva; sem reserva livre processa a mais antiga antes
+static int8_t* claim_input(void) {
+    for (;;) {
+        if (slot_count == 0) {
+            int8_t* in = tflm_input_acquire();
+            if (in) return in;
+        }
+        for (int i = 0; i < PROTO_WINDOW - 1; i++) {
+            if (!(spare_used & (1u << i))) {
+                spare_used |= (uint8_t)(1u << i);
+                return spare_inputs[i];
+            }
+        }
+        process_next_slot();
+    }
+}
+// Comandos de controle ("$...")
+//   $EVAL ON | OFF | RESET | DUMP   modo avaliação com matriz de confusão
+//   $STATS [RESET]                  histogramas por estágio e contadores (CNN_TELEMETRY)
+//   $TRACE [RESET]                  dump binário do ring de eventos (CNN_TRACE)
+//   $MEM                            mapa de memória do pool e folga
+//   $CONV [FAST|REF|RESET]          tempo por camada de conv, kernel próprio x referência
+//   $MODEL [BEGIN|DATA|COMMIT|CLEAR]  modelo na partição da flash (ver model_store.h)
+//   $DISPLAY [FPS n | MODE SAMPLE|STATS]  ritmo e conteúdo do display
+//   $SELFTEST                       roda as amostras da flash (ver selftest.h)
+//   $SCHED [RESET]                  tempo por tarefa do loop principal (ver task_sched.h)
+//   $BOOT                           tempo de cada fase do boot (ver boot.h)
+static void handle_command(const char* cmd) {
+    if (strncmp(cmd, "EVAL", 4) == 0) {
+        const char* arg = cmd + 4;
+        while (*arg == ' ') arg++;
+        if (strcmp(arg, "ON") == 0) {
+            eval_mode = true;
+        } else if (strcmp(arg, "OFF") == 0) {
+            eval_mode = false;
+        } else if (strcmp(arg, "RESET") == 0) {
+            eval_reset(&eval);
+        } else if (strcmp(arg, "DUMP") == 0) {
+            drain_slots();  // inclui o que ainda está na fila
+            eval_dump(&eval);
+            return;
+        } else {
+            printf("ERR,EVAL\n");
+            return;
+        }
+        printf("OK,EVAL,%s\n", arg);
         return;
     }
-    printf("Invoke OK\n\n");
-    // Converte saída int8 pra probabilidades em %
-    float probs[10];
-    softmax_i8_to_probs(out, out_scale, out_zp, probs, 10);
-    // Exibe todas as probabilidades na serial
-    printf("Probabilidades:\n");
-    for (int i = 0; i < 10; i++) {
-        printf("  %d: %6.2f%%", i, probs[i]);
-        if (i == label) printf(" <- real");  // marca qual é o label verdadeiro
-        printf("\n");
+#if CNN_TELEMETRY
+    if (strcmp(cmd, "STATS") == 0) {
+        drain_slots();
+        telem_dump();
+        return;
     }
-    // Calcula predição (classe com maior probabilidade)
-    int pred = argmax_i8(out, 10);
-    bool correct = (pred == label);
-    printf("\nResultado: pred=%d real=%d %s (confianca: %.1f%%)\n\n", 
-           pred, label, correct ? "OK" : "ERRO", probs[pred]);
-    show_results(probs, label);    // Atualiza display OLED
+    if (strcmp(cmd, "STATS RESET") == 0) {
+        telem_reset();
+        printf("OK,STATS,RESET\n");
+        return;
+    }
+#endif
+#if CNN_TRACE
+    if (strcmp(cmd, "TRACE") == 0) {
+        drain_slots();
+        trace_dump();
+        return;
+    }
+    if (strcmp(cmd, "TRACE RESET") == 0) {
+        trace_reset();
+        printf("OK,TRACE,RESET\n");
+        return;
+    }
+#endif
+    if (strncmp(cmd, "MODEL", 5) == 0) {
+        drain_slots();  // o COMMIT reinicia: responde a fila antes
+        model_store_command(cmd + 5);
+        return;
+    }
+    if (strcmp(cmd, "MEM") == 0) {
+        mem_pool_report();
+        return;
+    }
+    if (strncmp(cmd, "CONV", 4) == 0) {
+        drain_slots();  // os invokes da fila entram na conta
+        tflm_conv_command(cmd + 4);
+        return;
+    }
+#if CNN_SELFTEST
+    if (strcmp(cmd, "SELFTEST") == 0) {
+        drain_slots();  // o teste usa o tensor de entrada
+        selftest_result_t st;
+        selftest_run(&st);
+        selftest_print(&st);
+        return;
+    }
+#endif
+    if (strcmp(cmd, "BOOT") == 0) {
+        boot_report();
+        return;
+    }
+    if (strcmp(cmd, "SCHED") == 0) {
+        sched_report();
+        return;
+    }
+    if (strcmp(cmd, "SCHED RESET") == 0) {
+        sched_reset();
+        printf("OK,SCHED,RESET\n");
+        return;
+    }
+    if (strncmp(cmd, "DISPLAY", 7) == 0) {
+        const char* arg = cmd + 7;
+        while (*arg == ' ') arg++;
+        if (strncmp(arg, "FPS ", 4) == 0) {
+            // Só um 0 explícito vira síncrono; lixo ou fora de 0..60 é erro
+            char* end;
+            long fps = strtol(arg + 4, &end, 10);
+            while (*end == ' ') end++;
+            if (end == arg + 4 || *end != '\0' || fps < 0 || fps > 60) {
+                printf("ERR,DISPLAY\n");
+                return;
+            }
+            display_set_fps((uint32_t)fps);
+        } else if (strcmp(arg, "MODE SAMPLE") == 0) {
+            display_set_mode(DISPLAY_MODE_SAMPLE);
+        } else if (strcmp(arg, "MODE STATS") == 0) {
+            display_set_mode(DISPLAY_MODE_STATS);
+        } else if (*arg != '\0') {
+            printf("ERR,DISPLAY\n");
+            return;
+        }
+        display_report();
+        return;
+    }
+    printf("ERR,CMD\n");
 }
-int main() {
-    stdio_init_all();
-    sleep_ms(2000);  // aguarda inicialização da serial
-    printf("\nMNIST CNN INT8 - Raspberry Pi Pico W + TFLite Micro\n");
-    printf("Modo: Probabilidades em %%\n\n");
+// Recepção em streaming: cada char passa pelo crc e pelo decodificador, que escreve
+// o pixel já quantizado no destino; não existe buffer da linha inteira
+typedef enum {
+    RX_START,    // início de linha
+    RX_CMD,      // "$..."
+    RX_QUERY,    // "@?"
+    RX_ID,       // "@<id>"
+    RX_ENC,      // primeiro char do payload: 'R', 'S' ou dígito do label (CSV)
+    RX_ENC_SEP,  // ',' depois de 'R'/'S'
+    RX_LABEL,
+    RX_DATA,     // pixels até o '*' (ou fim da linha no CSV antigo)
+    RX_CRC,
+    RX_SKIP,     // ignora até o fim da linha, resposta decidida pelas flags
+    RX_DISCARD,  // linha já respondida (estouro), só espera o fim
+} rx_state_t;
+
+typedef struct {
+    rx_state_t state;
+    bool framed;      // começou com '@'
+    bool have_id;
+    bool bad;         // payload inválido (vira NAK PARSE se o crc conferir)
+    bool star;        // já passou do '*'
+    bool crc_bad;
+    uint32_t id;
+    int id_digits;
+    char enc;
+    int label;
+    int label_digits;
+    uint16_t crc;     // crc calculado de tudo entre '@' e '*'
+    uint16_t crc_rx;
+    int crc_digits;
+    int len;          // chars da linha (vira rx_bytes)
+    int8_t* target;   // destino dos pixels
+    codec_stream_t codec;
+    uint32_t codec_us;  // tempo dentro do codec_stream_put nessa linha
+    char cmd[RX_CMD_MAX];
+    int cmd_len;
+    bool done;        // '\n' lido, esperando a tarefa de parse fechar a linha
+} rx_line_t;
+static rx_line_t rx;
+
+static void rx_reset(void) {
+    memset(&rx, 0, sizeof(rx));
+    rx.state = RX_START;
+}
+// Label lido: reserva o destino e começa a decodificar os pixels
+static void rx_begin_data(void) {
+    rx.target = claim_input();
+    codec_stream_begin(&rx.codec, rx.enc, rx.target, input_lut);
+    rx.state = RX_DATA;
+}
+// Frame mal formado depois do id: continua o crc até o '*' pra decidir entre CRC e PARSE
+static void rx_fail(void) {
+    rx.bad = true;
+    rx.state = rx.framed ? RX_DATA : RX_SKIP;
+}
+static void rx_label_char(char c) {
+    if (c >= '0' && c <= '9' && rx.label_digits < 7) {
+        rx.label = rx.label * 10 + (c - '0');
+        rx.label_digits++;
+    } else if ((c == ',' || (c == ' ' && !rx.framed)) && rx.label_digits > 0) {
+        rx_begin_data();
+    } else {
+        rx_fail();
+    }
+}
+static void rx_char(char c) {
+    if (rx.len == 0) line_start_us = time_us_32();
+    rx.len++;
+    if (rx.framed && !rx.star && c != '*' && rx.state >= RX_ID && rx.state <= RX_DATA) {
+        rx.crc = proto_crc16_update(rx.crc, c);
+    }
+    switch (rx.state) {
+        case RX_START:
+            if (c == '$') {
+                rx.state = RX_CMD;
+            } else if (c == '@') {
+                rx.framed = true;
+                rx.crc = PROTO_CRC_INIT;
+                rx.state = RX_ID;
+            } else if (c != ' ') {
+                rx.enc = CODEC_CSV;  // modo antigo: label,p1,...,p784
+                rx.state = RX_LABEL;
+                rx_label_char(c);
+            }
+            break;
+        case RX_CMD:
+            if (rx.cmd_len < RX_CMD_MAX - 1) rx.cmd[rx.cmd_len++] = c;
+            break;
+        case RX_ID:
+            if (c >= '0' && c <= '9' && rx.id_digits < 10) {
+                rx.id = rx.id * 10 + (uint32_t)(c - '0');
+                rx.id_digits++;
+            } else if (c == ',' && rx.id_digits > 0) {
+                rx.have_id = true;
+                rx.state = RX_ENC;
+            } else if (c == '?' && rx.len == 2) {
+                rx.state = RX_QUERY;
+            } else {
+                rx.state = RX_SKIP;  // sem id legível -> FMT
+            }
+            break;
+        case RX_ENC:
+            if (c == CODEC_RLE || c == CODEC_SPARSE) {
+                rx.enc = c;
+                rx.state = RX_ENC_SEP;
+            } else {
+                rx.enc = CODEC_CSV;
+                rx.state = RX_LABEL;
+                if (c == '*') {
+                    rx.bad = true;
+                    rx.star = true;
+                    rx.state = RX_CRC;
+                } else {
+                    rx_label_char(c);
+                }
+            }
+            break;
+        case RX_ENC_SEP:
+        case RX_LABEL:
+        case RX_DATA:
+            if (rx.framed && c == '*') {
+                if (rx.state != RX_DATA) rx.bad = true;
+                rx.star = true;
+                rx.state = RX_CRC;
+            } else if (rx.state == RX_ENC_SEP) {
+                if (c == ',') rx.state = RX_LABEL;
+                else rx_fail();
+            } else if (rx.state == RX_LABEL) {
+                rx_label_char(c);
+            } else if (rx.target) {
+                // Cada chamada dura menos de 1 us: a diferença sai 0 ou 1, mas a soma
+                // é uma estimativa sem viés do total (a chance de virar o contador é a duração)
+                uint32_t t = time_us_32();
+                codec_stream_put(&rx.codec, c);
+                rx.codec_us += time_us_32() - t;
+            }
+            break;
+        case RX_CRC: {
+            int v = (c >= '0' && c <= '9') ? c - '0'
+                  : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if (c == ' ') {
+                rx.state = RX_SKIP;  // resto da linha ignorado, como no parser antigo
+            } else if (v < 0 || rx.crc_digits == 4) {
+                rx.crc_bad = true;
+            } else {
+                rx.crc_rx = (uint16_t)((rx.crc_rx << 4) | v);
+                rx.crc_digits++;
+            }
+            break;
+        }
+        case RX_QUERY:
+        case RX_SKIP:
+        case RX_DISCARD:
+            break;
+    }
+    // Feedback visual a cada 500 chars (linha CSV é grande), só no modo antigo
+    if (rx.len % 500 == 0 && !rx.framed && rx.state != RX_CMD && !eval_mode) {
+        printf("Recebendo: %d chars...\n", rx.len);
+    }
+}
+// Enfileira a amostra que acabou de chegar (o destino passa a ser do slot)
+static void rx_push_slot(uint32_t decode_us) {
+    sample_slot_t* s = &slots[(slot_head + slot_count) % PROTO_WINDOW];
+    s->id = rx.id;
+    s->framed = rx.framed;
+    s->label = (uint8_t)(rx.label & 0xFF);
+    s->rx_bytes = (uint16_t)rx.len;
+    s->decode_us = decode_us;
+    s->input = rx.target;
+#if CNN_DUAL_CORE
+    s->run = SLOT_QUEUED;
+#endif
+    rx.target = NULL;
+    slot_count++;
+    sched_signal(TASK_INFER);
+}
+// Fim de um frame "@...": valida crc e imagem e enfileira ou manda NAK
+static void rx_end_frame(void) {
+    uint32_t t0 = time_us_32();
+    if (rx.state == RX_QUERY) {
+        out_push('W');
+        return;
+    }
+    if (!rx.have_id) {
+        out_nak(NULL, "FMT");
+        return;
+    }
+    if (!rx.star || rx.crc_bad || rx.crc_digits == 0 || rx.crc != rx.crc_rx) {
+        TELEM_COUNT(TELEM_CRC_FAIL);
+        release_input(rx.target);
+        out_nak(&rx.id, "CRC");
+        return;
+    }
+    if (rx.bad || !rx.target || codec_stream_end(&rx.codec) != 0) {
+        TELEM_COUNT(TELEM_PARSE_FAIL);
+        release_input(rx.target);
+        out_nak(&rx.id, "PARSE");
+        return;
+    }
+    rx_push_slot(rx.codec_us + (time_us_32() - t0));
+    TELEM_SPAN(TELEM_PARSE, t0);
+}
+// Trata o fim da linha: comando ("$..."), frame com id ("@..."), consulta de janela ou CSV antigo
+static void rx_end_line(void) {
+    if (rx.state == RX_DISCARD) return;
+    if (rx.state == RX_CMD) {
+        rx.cmd[rx.cmd_len] = '\0';
+        out_flush();  // a resposta do comando sai depois das que já estavam na fila
+        handle_command(rx.cmd);
+        return;
+    }
+    if (rx.framed) {
+        rx_end_frame();
+        return;
+    }
+    // Modo antigo: linha CSV crua, saída verbosa (silenciosa no modo avaliação)
+    if (!eval_mode) printf("Recebido %d chars\n", rx.len);
+    TELEM_BEGIN(TELEM_PARSE, t_parse);
+    bool ok = !rx.bad && rx.state == RX_DATA && codec_stream_end(&rx.codec) == 0;
+    TELEM_END(TELEM_PARSE, t_parse);
+    if (ok) {
+        if (!eval_mode) printf("Parse OK\n");
+        rx_push_slot(rx.codec_us);
+    } else {
+        TELEM_COUNT(TELEM_PARSE_FAIL);
+        release_input(rx.target);
+        printf("Parse FALHOU - formato: label,p1,p2,...,p784\n\n");
+    }
+}
+// Linha abandonada no meio (timeout/estouro): NAK se era um frame do protocolo
+static void rx_abort(const char* reason) {
+    release_input(rx.target);
+    rx.target = NULL;
+    if (rx.framed) out_nak(rx.have_id ? &rx.id : NULL, reason);
+}
+// Um char da serial: fim de linha, estouro ou decodificador
+static void rx_put(int ch) {
+    // Enter ou newline: a linha fica pra tarefa de parse, a recepção para até ela fechar
+    if (ch == '\n' || ch == '\r') {
+        if (rx.len > 0) {
+            TELEM_SPAN(TELEM_RX, line_start_us);
+            rx.done = true;
+            sched_signal(TASK_PARSE);
+        }
+    }
+    else if (rx.state == RX_DISCARD) {
+        // ignora o resto da linha grande demais
+    }
+    // Char normal: vai direto pro decodificador
+    else if (rx.len < RX_LINE_MAX) {
+        if (ch >= 32 && ch <= 126) {  // char imprimível
+            rx_char((char)ch);
+        } else if (ch == '\t') {
+            rx_char(' ');  // converte tab em espaço
+        }
+    } else {
+        // Linha longa demais, descarta até o fim
+        TELEM_COUNT(TELEM_OVERFLOW);
+        if (rx.framed) {
+            rx_abort("OVF");
+        } else {
+            release_input(rx.target);
+            rx.target = NULL;
+            printf("Buffer cheio! Resetando\n");
+        }
+        rx.state = RX_DISCARD;
+    }
+}
+// Chegou algo na serial (interrupção do USB)
+static void rx_chars_available(void* arg) {
+    (void)arg;
+    sched_signal(TASK_RX);
+}
+// Lê o que já chegou até o fim de uma linha; com linha pela metade arma o timeout
+// O resto fica no buffer do USB enquanto a linha completa espera o parse
+static bool task_rx(uint32_t now_us) {
+    int ch;
+    bool got = false;
+    while (!rx.done && (ch = getchar_timeout_us(0)) >= 0) {
+        rx_put(ch);
+        got = true;
+    }
+    if (got) {
+        last_byte_time = get_absolute_time();
+        if (rx.len > 0 && !rx.done) sched_wake_at(TASK_TIMEOUT, now_us + RX_TIMEOUT_US);
+    }
+    return false;
+}
+// Fecha a linha recebida (crc, validação, comando) e libera a recepção da próxima
+static bool task_parse(uint32_t now_us) {
+    (void)now_us;
+    if (!rx.done) return false;
+    rx_end_line();
+    rx_reset();
+    sched_signal(TASK_RX);
+    sched_signal(TASK_DISPLAY);  // comando pode ter mudado fps/modo
+    return false;
+}
+// Uma resposta por execução, só com espaço no USB: o printf não bloqueia o loop
+static bool task_out(uint32_t now_us) {
+    if (out_count == 0) return false;
+    if (!out_room()) {
+        sched_wake_at(TASK_OUT, now_us + OUT_POLL_US);
+        return false;
+    }
+    out_send_one();
+    return out_count > 0;
+}
+#if CNN_DUAL_CORE
+static bool has_queued(void) {
+    for (int k = 0; k < slot_count; k++) {
+        if (slot_at(k)->run == SLOT_QUEUED) return true;
+    }
+    return false;
+}
+#endif
+// Serial ociosa: uma amostra (ou batch) por execução, o escalonador decide se
+// o display ou a recepção entram antes da próxima
+static bool task_infer(uint32_t now_us) {
+    if (slot_count == 0 || out_count == OUT_QUEUE_LEN) return false;  // a saída sinaliza quando abrir lugar
+    process_next_slot();
+#if CNN_DUAL_CORE
+    if (slot_count > 0 && !has_queued()) {
+        // Sobrou só o que está no core1: o SEV dele acorda o core0 ou o prazo
+        sched_wake_at(TASK_INFER, now_us + CORE1_POLL_US);
+        return false;
+    }
+#else
+    (void)now_us;
+#endif
+    return slot_count > 0;
+}
+static bool task_display(uint32_t now_us) {
+    if (display_poll(now_us)) return true;
+    uint32_t wait = display_wait_us(now_us);
+    if (wait != UINT32_MAX) sched_wake_at(TASK_DISPLAY, now_us + wait);
+    return false;
+}
+// Linha parada há mais de RX_TIMEOUT_US: abandona (NAK se era frame)
+static bool task_timeout(uint32_t now_us) {
+    int64_t elapsed = absolute_time_diff_us(last_byte_time, get_absolute_time());
+    if (rx.len == 0 || rx.done || rx.state == RX_DISCARD) return false;
+    if (elapsed <= RX_TIMEOUT_US) {
+        sched_wake_at(TASK_TIMEOUT, now_us + (uint32_t)(RX_TIMEOUT_US - elapsed) + 1);
+        return false;
+    }
+    TELEM_COUNT(TELEM_TIMEOUT);
+    if (rx.framed) {
+        rx_abort("TIMEOUT");
+    } else {
+        release_input(rx.target);
+        printf("Timeout - resetando (%d chars)\n", rx.len);
+    }
+    rx_reset();
+    return false;
+}
+// I2C, config do SSD1306 e tela de espera (~30 ms de I2C): no core1 com
+// CNN_BOOT_PARALLEL, enquanto o core0 monta o interpretador
+static void boot_display(void) {
+    boot_begin(BOOT_DISPLAY);
     // Configura I2C pro display OLED
     i2c_init(i2c1, 400 * 1000);           // 400kHz
     gpio_set_function(14, GPIO_FUNC_I2C);  // GP14 = SDA
     gpio_set_function(15, GPIO_FUNC_I2C);  // GP15 = SCL
     gpio_pull_up(14);
     gpio_pull_up(15);
-    // Inicializa display SSD1306 128x64
-    ssd1306_init(&display, 128, 64, false, 0x3C, i2c1);
     ssd1306_config(&display);
     ssd1306_fill(&display, false);
     ssd1306_draw_string(&display, "MNIST CNN", 0, 0, false);
     ssd1306_draw_string(&display, "Modo: Probs %", 0, 16, false);
     ssd1306_draw_string(&display, "Aguarde...", 0, 28, false);
     ssd1306_send_data(&display);
+    boot_end(BOOT_DISPLAY);
+}
+#if CNN_BOOT_PARALLEL
+static void boot_display_core1(void) {
+    boot_display();
+    multicore_fifo_push_blocking(1);  // avisa o core0, que reseta este núcleo
+}
+#endif
+int main() {
+    stdio_init_all();
+    trace_init();
+    // Inicializa display SSD1306 128x64 (o buffer vem do pool, que só o core0 usa)
+    ssd1306_init(&display, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, 0x3C, i2c1,
+                 (uint8_t*)mem_pool_alloc(MEM_DISPLAY));
+#if CNN_BOOT_PARALLEL
+    multicore_launch_core1(boot_display_core1);
+#else
+    boot_display();
+#endif
     // Inicializa TensorFlow Lite Micro
-    printf("Inicializando TensorFlow Lite Micro...\n");
+    boot_begin(BOOT_TFLM);
     int rc = tflm_init();
+    boot_end(BOOT_TFLM);
+#if CNN_BOOT_PARALLEL
+    multicore_fifo_pop_blocking();  // display pronto: o I2C volta pro core0
+    multicore_reset_core1();        // livre pro dual_core_start
+#endif
     if (rc != 0) {
+        boot_wait_usb();
         printf("ERRO tflm_init: %d\n", rc);
         ssd1306_fill(&display, false);
         ssd1306_draw_string(&display, "ERROR!", 0, 0, false);
@@ -221,74 +893,78 @@ int main() {
         ssd1306_send_data(&display);
         while (1) tight_loop_contents();
     }
-    
+#if CNN_DUAL_CORE
+    dual_core_start();
+#endif
+#if CNN_SELFTEST && CNN_SELFTEST_BOOT
+    // Amostras da flash antes de tudo: prova que modelo, kernels e arena estão sãos
+    selftest_result_t st;
+    boot_begin(BOOT_SELFTEST);
+    selftest_run(&st);
+    boot_end(BOOT_SELFTEST);
+#endif
+    // Só agora espera o terminal: o que sobrar dos prazos depois do trabalho acima
+    boot_wait_usb();
+    printf("\nMNIST CNN INT8 - Raspberry Pi Pico W + TFLite Micro\n");
+    printf("Modo: Probabilidades em %%\n\n");
     printf("TFLM OK - Arena usado: %d bytes\n", tflm_arena_used_bytes());
+    uint32_t model_bytes;
+    tflm_model_data(&model_bytes);
+    if (tflm_model_slot() >= 0) printf("Modelo: slot %d da flash (%lu bytes)\n", tflm_model_slot(), (unsigned long)model_bytes);
+    else printf("Modelo: embutido (%lu bytes)\n", (unsigned long)model_bytes);
+#if CNN_DUAL_CORE
+    printf("Core1: segunda instancia, arena usado: %d bytes\n", tflm_instance_arena_used_bytes(1));
+#endif
+#if CNN_SELFTEST && CNN_SELFTEST_BOOT
+    selftest_print(&st);
+#endif
+    input_tensor = tflm_input_ptr(NULL);
+    build_input_lut(input_lut, tflm_input_scale(), tflm_input_zero_point());  // recepção só indexa a tabela
+    spare_inputs = (int8_t (*)[MNIST_SIZE])mem_pool_alloc(MEM_INPUT_SPARES);
+    mem_pool_report();  // mapa de memória no boot: consumidores e folga do pool
     // Atualiza display pra modo pronto
     ssd1306_fill(&display, false);
     ssd1306_draw_string(&display, "PRONTO!", 0, 0, false);
     ssd1306_draw_string(&display, "Envie linha CSV:", 0, 16, false);
     ssd1306_draw_string(&display, "label,p1,...,p784", 0, 28, false);
-    ssd1306_send_data(&display);
+#if CNN_SELFTEST && CNN_SELFTEST_BOOT
+    char st_line[24];  // 16 colunas no display
+    if (st.status >= 0) {
+        uint32_t acc = st.total ? (uint32_t)(((uint64_t)st.correct * 1000u + st.total / 2) / st.total) : 0;
+        snprintf(st_line, sizeof(st_line), "Teste %lu.%lu%% %s", (unsigned long)(acc / 10), (unsigned long)(acc % 10),
+                 st.status == SELFTEST_OK ? "OK" : st.status == SELFTEST_FAIL ? "CRC!" : "");
+    } else {
+        snprintf(st_line, sizeof(st_line), "Teste: ERRO");
+    }
+    ssd1306_draw_string(&display, st_line, 0, 44, false);
+#endif
+    display_task_init(&display);  // envia a tela em pedaços; daqui pra frente o display só muda pelo display_poll
     printf("\nFormato esperado: label,pixel1,pixel2,...,pixel784\n");
     printf("Cole uma linha do CSV de teste e pressione ENTER\n");
     printf("Aguardando dados...\n\n");
     
-    csv_pos = 0;
+    proto_send_window(free_slots());  // anuncia a janela pro host com protocolo
+    
+    rx_reset();
     last_byte_time = get_absolute_time();
-    // Loop principal: recebe dados via serial e processa
-    while (1) {
-        int ch = getchar_timeout_us(100);  // tenta ler char com timeout de 100us
-        
-        if (ch >= 0) {  // recebeu algum char
-            last_byte_time = get_absolute_time();  // atualiza timestamp
-            
-            // Enter ou newline: processa a linha recebida
-            if (ch == '\n' || ch == '\r') {
-                if (csv_pos > 0) {
-                    csv_buffer[csv_pos] = '\0';  // termina string
-                    
-                    printf("Recebido %d chars\n", csv_pos);
-                    
-                    uint8_t label;
-                    uint8_t pixels[MNIST_SIZE];
-                    
-                    // Faz parse da linha CSV
-                    if (parse_csv_line(csv_buffer, &label, pixels) == 0) {
-                        printf("Parse OK\n");
-                        run_inference(label, pixels);  // executa inferência
-                    } else {
-                        printf("Parse FALHOU - formato: label,p1,p2,...,p784\n\n");
-                    }
-                    
-                    csv_pos = 0;  // reseta buffer
-                }
-            } 
-            // Char normal: adiciona no buffer
-            else if (csv_pos < CSV_BUFFER_SIZE - 1) {
-                if (ch >= 32 && ch <= 126) {  // char imprimível
-                    csv_buffer[csv_pos++] = (char)ch;
-                } else if (ch == '\t') {
-                    csv_buffer[csv_pos++] = ' ';  // converte tab em espaço
-                }
-                
-                // Feedback visual a cada 500 chars (linha CSV é grande)
-                if (csv_pos % 500 == 0) {
-                    printf("Recebendo: %d chars...\n", csv_pos);
-                }
-            } else {
-                // Buffer estourou, reseta
-                printf("Buffer cheio! Resetando\n");
-                csv_pos = 0;
-            }
-        } else {
-            // Nenhum char recebido, verifica timeout
-            int64_t elapsed = absolute_time_diff_us(last_byte_time, get_absolute_time());
-            if (csv_pos > 0 && elapsed > 3000000) {  // 3 segundos sem receber nada
-                printf("Timeout - resetando (%d chars)\n", csv_pos);
-                csv_pos = 0;
-            }
-        }
-        tight_loop_contents();  // yield pra watchdog
-    }
+    // Loop principal: tarefas curtas num escalonador cooperativo, o núcleo dorme
+    // quando nenhuma tem o que fazer. A recepção tem prioridade sobre a fila, assim
+    // o host pode manter até PROTO_WINDOW requisições em voo sem esperar cada resposta
+    // e a fila só é consumida quando a serial fica ociosa; entre duas amostras o
+    // display avança no máximo um pedaço, limitado pelo fps e não pela vazão.
+    // As respostas saem pela tarefa de saída, acima da inferência: com o USB
+    // cheio o invoke segue até encher a fila de respostas
+    sched_add(TASK_RX, "rx", task_rx, RX_POLL_US);
+    sched_add(TASK_PARSE, "parse", task_parse, 0);
+    sched_add(TASK_OUT, "out", task_out, 0);
+    sched_add(TASK_DISPLAY, "display", task_display, 0);
+    sched_add(TASK_INFER, "infer", task_infer, 0);
+    sched_add(TASK_TIMEOUT, "timeout", task_timeout, 0);
+    stdio_set_chars_available_callback(rx_chars_available, NULL);
+    sched_signal(TASK_RX);
+    sched_signal(TASK_DISPLAY);
+    boot_ready();
+    boot_report();
+    sched_run();
     return 0;
 }
@@ -0,0 +1,164 @@
+#include "conv_kernels.h"
+#include <string.h>
+
+// gemmlowp::SaturatingRoundingDoublingHighMul
+static inline int32_t rounding_doubling_high_mul(int32_t a, int32_t b) {
+    if (a == b && a == INT32_MIN) return INT32_MAX;
+    int64_t ab = (int64_t)a * b;
+    int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+    return (int32_t)((ab + nudge) / (1ll << 31));  // divisão (trunca pra zero), não shift
+}
+
+// gemmlowp::RoundingDivideByPOT
+static inline int32_t rounding_divide_by_pot(int32_t x, int exponent) {
+    int32_t mask = (int32_t)((1ll << exponent) - 1);
+    int32_t remainder = x & mask;
+    int32_t threshold = (mask >> 1) + (x < 0);
+    return (x >> exponent) + (remainder > threshold);
+}
+
+static inline int8_t requant_out(const conv3x3s2_params_t* p, int oc, int32_t acc) {
+    int32_t shift = p->shift[oc];
+    int32_t left = shift > 0 ? shift : 0;
+    acc = (int32_t)((uint32_t)acc << left);  // o TFLM multiplica por 1 << left em int32
+    acc = rounding_divide_by_pot(rounding_doubling_high_mul(acc, p->mult[oc]), shift > 0 ? 0 : -shift);
+    acc += p->out_zp;
+    if (acc < p->act_min) acc = p->act_min;
+    if (acc > p->act_max) acc = p->act_max;
+    return (int8_t)acc;
+}
+
+void conv3x3s2_fold_bias(const int8_t* filter, const int32_t* bias, int out_c, int in_c, int32_t in_zp,
+                         int32_t* bias_folded) {
+    const int n = 9 * in_c;
+    for (int oc = 0; oc < out_c; oc++, filter += n) {
+        int32_t sum = 0;
+        for (int i = 0; i < n; i++) sum += filter[i];
+        bias_folded[oc] = (bias ? bias[oc] : 0) - in_zp * sum;
+    }
+}
+
+// Uma janela 3x3 -> out_c saídas. r0..r2 são as 3 linhas da janela (3*ic bytes cada)
+typedef void (*window_fn)(const conv3x3s2_params_t* p, const int8_t* r0, const int8_t* r1, const int8_t* r2,
+                          int8_t* out);
+
+// ic = 1 (primeira camada): os 9 pixels ficam em registrador pros out_c canais
+static void window_ic1(const conv3x3s2_params_t* p, const int8_t* r0, const int8_t* r1, const int8_t* r2,
+                       int8_t* out) {
+    const int32_t x0 = r0[0], x1 = r0[1], x2 = r0[2];
+    const int32_t x3 = r1[0], x4 = r1[1], x5 = r1[2];
+    const int32_t x6 = r2[0], x7 = r2[1], x8 = r2[2];
+    const int8_t* w = p->filter;
+    for (int oc = 0; oc < p->out_c; oc++, w += 9) {
+        int32_t acc = p->bias_folded[oc];
+        acc += w[0] * x0 + w[1] * x1 + w[2] * x2;
+        acc += w[3] * x3 + w[4] * x4 + w[5] * x5;
+        acc += w[6] * x6 + w[7] * x7 + w[8] * x8;
+        out[oc] = requant_out(p, oc, acc);
+    }
+}
+
+#define MAC8(acc, x, w)                                                           \
+    acc += (x)[0] * (w)[0] + (x)[1] * (w)[1] + (x)[2] * (w)[2] + (x)[3] * (w)[3] + \
+           (x)[4] * (w)[4] + (x)[5] * (w)[5] + (x)[6] * (w)[6] + (x)[7] * (w)[7]
+
+// ic = 8 (segunda camada): 72 produtos por canal, todos desenrolados
+static void window_ic8(const conv3x3s2_params_t* p, const int8_t* r0, const int8_t* r1, const int8_t* r2,
+                       int8_t* out) {
+    const int8_t* w = p->filter;
+    for (int oc = 0; oc < p->out_c; oc++, w += 72) {
+        int32_t acc = p->bias_folded[oc];
+        MAC8(acc, r0, w);
+        MAC8(acc, r0 + 8, w + 8);
+        MAC8(acc, r0 + 16, w + 16);
+        MAC8(acc, r1, w + 24);
+        MAC8(acc, r1 + 8, w + 32);
+        MAC8(acc, r1 + 16, w + 40);
+        MAC8(acc, r2, w + 48);
+        MAC8(acc, r2 + 8, w + 56);
+        MAC8(acc, r2 + 16, w + 64);
+        out[oc] = requant_out(p, oc, acc);
+    }
+}
+
+static void window_generic(const conv3x3s2_params_t* p, const int8_t* r0, const int8_t* r1, const int8_t* r2,
+                           int8_t* out) {
+    const int n = 3 * p->in_c;
+    const int8_t* w = p->filter;
+    for (int oc = 0; oc < p->out_c; oc++, w += 3 * n) {
+        int32_t acc = p->bias_folded[oc];
+        for (int i = 0; i < n; i++) acc += r0[i] * w[i] + r1[i] * w[n + i] + r2[i] * w[2 * n + i];
+        out[oc] = requant_out(p, oc, acc);
+    }
+}
+
+static window_fn pick_window(int ic) {
+    return ic == 1 ? window_ic1 : ic == 8 ? window_ic8 : window_generic;
+}
+
+void conv3x3s2_blank_outputs(const conv3x3s2_params_t* p, int8_t* blank) {
+    int8_t zp[3 * CONV3X3S2_MAX_IC];
+    memset(zp, (int8_t)p->in_zp, sizeof(zp));
+    pick_window(p->in_c)(p, zp, zp, zp, blank);  // mesma conta do kernel: bit a bit por construção
+}
+
+// occ[y] bit x = pixel (y, x) tem algum canal fora do zero point
+static void occupancy(const conv3x3s2_params_t* p, const int8_t* in, uint32_t* occ) {
+    const int8_t zp = (int8_t)p->in_zp;
+    for (int y = 0; y < p->in_h; y++) {
+        uint32_t line = 0;
+        for (int x = 0; x < p->in_w; x++) {
+            for (int k = 0; k < p->in_c; k++, in++) {
+                if (*in != zp) line |= 1u << x;
+            }
+        }
+        occ[y] = line;
+    }
+}
+
+// Os 3 bits da janela que começa na coluna x0 (pode ser -1 com padding)
+static inline uint32_t window_bits(uint32_t mask, int x0) {
+    return (x0 >= 0 ? mask >> x0 : mask << -x0) & 7u;
+}
+
+void conv3x3s2_i8(const conv3x3s2_params_t* p, const int8_t* in, int8_t* out) {
+    const int ic = p->in_c;
+    const int row = p->in_w * ic;
+    const window_fn window = pick_window(ic);
+    int8_t border[3][3 * CONV3X3S2_MAX_IC];  // janela da borda, com in_zp no lugar do padding
+    const int skip = p->blank && p->in_h <= 32 && p->in_w <= 32;
+    uint32_t occ[32];
+    if (skip) occupancy(p, in, occ);
+
+    for (int oy = 0; oy < p->out_h; oy++) {
+        const int iy0 = oy * 2 - p->pad_h;
+        const int rows_in = iy0 >= 0 && iy0 + 3 <= p->in_h;
+        // Colunas ocupadas nas 3 linhas da janela (fora da entrada é padding: vazio)
+        uint32_t cols = 0;
+        for (int ky = 0; skip && ky < 3; ky++) {
+            if (iy0 + ky >= 0 && iy0 + ky < p->in_h) cols |= occ[iy0 + ky];
+        }
+        for (int ox = 0; ox < p->out_w; ox++, out += p->out_c) {
+            const int ix0 = ox * 2 - p->pad_w;
+            if (skip && !window_bits(cols, ix0)) {
+                memcpy(out, p->blank, p->out_c);  // janela toda no fundo
+                continue;
+            }
+            if (rows_in && ix0 >= 0 && ix0 + 3 <= p->in_w) {
+                const int8_t* r0 = in + iy0 * row + ix0 * ic;
+                window(p, r0, r0 + row, r0 + 2 * row, out);
+                continue;
+            }
+            for (int ky = 0; ky < 3; ky++) {
+                const int iy = iy0 + ky;
+                for (int kx = 0; kx < 3; kx++) {
+                    const int ix = ix0 + kx;
+                    int8_t* dst = border[ky] + kx * ic;
+                    if (iy >= 0 && iy < p->in_h && ix >= 0 && ix < p->in_w) memcpy(dst, in + iy * row + ix * ic, ic);
+                    else memset(dst, (int8_t)p->in_zp, ic);
+                }
+            }
+            window(p, border[0], border[1], border[2], out);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+
+// Conv2D int8 3x3 com stride 2 (as duas camadas do modelo: 1->8 e 8->16 canais).
+// Mesma conta do kernel de referência do TFLM (reference_integer_ops::ConvPerChannel,
+// requantização com arredondamento duplo), bit a bit, sem o custo genérico dele:
+//   - o zero point da entrada vai pro bias uma vez (bias - in_zp*soma(w)), e a borda
+//     do padding entra como in_zp, que contribui zero -> sem subtração nem teste por tap
+//   - no miolo as 3 linhas da janela são lidas direto da entrada (cada uma tem 3*ic
+//     bytes contíguos, no mesmo layout do filtro [oc][3][3][ic]); só a borda é copiada
+//   - laços desenrolados pra ic = 1 e ic = 8
+//   - com blank, janela toda no zero point da entrada (o fundo da imagem) não faz
+//     conta: a saída dela é a mesma pra qualquer janela assim (só o bias) e vem pronta
+// Fica em C puro (sem TFLM) pra host/kernel_check comparar contra a referência;
+// a ligação com o interpretador está em tflm_conv.cpp
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONV3X3S2_MAX_IC 32  // a janela da borda fica na pilha: 9*ic bytes
+
+typedef struct {
+    int in_h, in_w, in_c;
+    int out_h, out_w, out_c;
+    int pad_h, pad_w;             // deslocamento do padding (TfLitePaddingValues.height/width)
+    int32_t in_zp, out_zp;
+    int32_t act_min, act_max;     // faixa da ativação já quantizada
+    const int8_t* filter;         // [out_c][3][3][in_c]
+    const int32_t* bias_folded;   // [out_c], de conv3x3s2_fold_bias
+    const int32_t* mult;          // [out_c] multiplicador de ponto fixo por canal
+    const int32_t* shift;         // [out_c] expoente (> 0 = esquerda)
+    const int8_t* blank;          // [out_c] de conv3x3s2_blank_outputs, NULL = sem atalho
+} conv3x3s2_params_t;
+
+// bias_folded[oc] = bias[oc] - in_zp * soma dos pesos do canal (bias NULL = zero)
+void conv3x3s2_fold_bias(const int8_t* filter, const int32_t* bias, int out_c, int in_c, int32_t in_zp,
+                         int32_t* bias_folded);
+
+// Saída de uma janela toda no zero point da entrada (p->blank não é usado).
+// Com entrada de até 32x32, o kernel faz uma passada marcando por linha as colunas
+// com algum valor fora do zero point e pula as janelas sem nenhum bit marcado
+void conv3x3s2_blank_outputs(const conv3x3s2_params_t* p, int8_t* blank);
+
+// Uma imagem (batch 1): in [in_h][in_w][in_c] -> out [out_h][out_w][out_c]
+void conv3x3s2_i8(const conv3x3s2_params_t* p, const int8_t* in, int8_t* out);
+
+#ifdef __cplusplus
+}
+#endif
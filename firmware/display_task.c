@@ -0,0 +1,166 @@
+#include "display_task.h"
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+static ssd1306_t* ssd = NULL;
+static uint32_t min_interval_us = 0;  // 0 = síncrono
+static display_mode_t mode = DISPLAY_MODE_SAMPLE;
+
+// Último resultado publicado (só o mais recente importa)
+static float last_probs[10];
+static uint8_t last_label;
+static int last_pred;
+static bool dirty = false;            // tem resultado que ainda não foi desenhado
+static bool sending = false;          // buffer sendo enviado em pedaços
+static uint32_t last_frame_us;        // início do último quadro
+
+static uint32_t frames = 0;
+static uint32_t coalesced = 0;        // resultados substituídos antes de aparecer
+
+// Média móvel: instante e acerto das últimas DISPLAY_ROLLING amostras
+static uint32_t roll_time[DISPLAY_ROLLING];
+static bool roll_ok[DISPLAY_ROLLING];
+static uint32_t roll_count = 0;       // total publicado (índice = roll_count % DISPLAY_ROLLING)
+
+void display_task_init(ssd1306_t* display) {
+    ssd = display;
+    display_set_fps(CNN_DISPLAY_FPS);
+    // A tela já desenhada no buffer vai em pedaços, sem segurar a primeira amostra
+    ssd1306_send_begin(ssd);
+    sending = true;
+    last_frame_us = time_us_32();
+}
+
+void display_set_fps(uint32_t fps) {
+    min_interval_us = fps ? 1000000u / fps : 0;
+}
+
+void display_set_mode(display_mode_t m) {
+    mode = m;
+    dirty = roll_count > 0;  // redesenha no modo novo
+}
+
+// Top 3 de predições com probabilidades (tela original do show_results)
+static void render_sample(void) {
+    typedef struct {
+        int digit;
+        float prob;
+    } prediction_t;
+    // Copia probabilidades pra struct que vai ser ordenada
+    prediction_t preds[10];
+    for (int i = 0; i < 10; i++) {
+        preds[i].digit = i;
+        preds[i].prob = last_probs[i];
+    }
+    // Ordena decrescente por probabilidade (bubble sort)
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 9 - i; j++) {
+            if (preds[j].prob < preds[j+1].prob) {
+                prediction_t temp = preds[j];
+                preds[j] = preds[j+1];
+                preds[j+1] = temp;
+            }
+        }
+    }
+    ssd1306_fill(ssd, false);
+    char line[24];
+    snprintf(line, sizeof(line), "REAL: %d", last_label);    // Linha 0: label verdadeiro
+    ssd1306_draw_string(ssd, line, 0, 0, false);
+    // Top 3 predições com probabilidades
+    snprintf(line, sizeof(line), "%d %.1f%%", preds[0].digit, preds[0].prob);
+    ssd1306_draw_string(ssd, line, 0, 14, false);
+    snprintf(line, sizeof(line), "%d %.1f%%", preds[1].digit, preds[1].prob);
+    ssd1306_draw_string(ssd, line, 0, 26, false);
+    snprintf(line, sizeof(line), "%d %.1f%%", preds[2].digit, preds[2].prob);
+    ssd1306_draw_string(ssd, line, 0, 38, false);
+    // Última linha: mostra se acertou ou errou
+    bool correct = (preds[0].digit == last_label);
+    snprintf(line, sizeof(line), "PRED:%d %s", preds[0].digit, correct ? "OK!" : "ERR");
+    ssd1306_draw_string(ssd, line, 0, 52, false);
+}
+
+// Acurácia e vazão nas últimas DISPLAY_ROLLING amostras
+static void render_stats(void) {
+    uint32_t n = roll_count < DISPLAY_ROLLING ? roll_count : DISPLAY_ROLLING;
+    uint32_t ok = 0;
+    for (uint32_t i = 0; i < n; i++) ok += roll_ok[i];
+    uint32_t newest = (roll_count - 1) % DISPLAY_ROLLING;
+    uint32_t oldest = (roll_count - n) % DISPLAY_ROLLING;
+    uint32_t span = roll_time[newest] - roll_time[oldest];
+    float rate = (n > 1 && span > 0) ? (float)(n - 1) * 1e6f / (float)span : 0.0f;
+
+    ssd1306_fill(ssd, false);
+    char line[24];
+    ssd1306_draw_string(ssd, "MNIST STATS", 0, 0, false);
+    snprintf(line, sizeof(line), "ACC %.1f%% /%lu", n ? 100.0f * (float)ok / (float)n : 0.0f, (unsigned long)n);
+    ssd1306_draw_string(ssd, line, 0, 14, false);
+    snprintf(line, sizeof(line), "%.1f AMOSTRAS/S", rate);
+    ssd1306_draw_string(ssd, line, 0, 26, false);
+    snprintf(line, sizeof(line), "TOTAL %lu", (unsigned long)roll_count);
+    ssd1306_draw_string(ssd, line, 0, 38, false);
+    snprintf(line, sizeof(line), "PRED:%d REAL:%d", last_pred, last_label);
+    ssd1306_draw_string(ssd, line, 0, 52, false);
+}
+
+static void render(void) {
+    TELEM_BEGIN(TELEM_DRAW, t_draw);
+    if (mode == DISPLAY_MODE_STATS) render_stats();
+    else render_sample();
+    TELEM_END(TELEM_DRAW, t_draw);
+    dirty = false;
+    frames++;
+    TELEM_COUNT(TELEM_FRAMES);
+}
+
+void display_post(const float* probs, uint8_t label, int pred, uint32_t now_us) {
+    if (dirty) {
+        coalesced++;  // o anterior nunca chegou na tela
+        TELEM_COUNT(TELEM_COALESCED);
+    }
+    memcpy(last_probs, probs, sizeof(last_probs));
+    last_label = label;
+    last_pred = pred;
+    roll_time[roll_count % DISPLAY_ROLLING] = now_us;
+    roll_ok[roll_count % DISPLAY_ROLLING] = (pred == label);
+    roll_count++;
+    dirty = true;
+    if (min_interval_us == 0 && !sending) {
+        // Síncrono: desenha e envia inteiro, como antes
+        render();
+        TELEM_BEGIN(TELEM_FLUSH, t_flush);
+        ssd1306_send_data(ssd);
+        TELEM_END(TELEM_FLUSH, t_flush);
+        last_frame_us = now_us;
+    }
+}
+
+bool display_poll(uint32_t now_us) {
+    if (!ssd) return false;
+    if (sending) {
+        TELEM_BEGIN(TELEM_FLUSH, t_flush);
+        sending = !ssd1306_send_step(ssd, DISPLAY_CHUNK_BYTES);
+        TELEM_END(TELEM_FLUSH, t_flush);
+        return true;
+    }
+    if (!dirty || now_us - last_frame_us < min_interval_us) return false;
+    // Quadro novo: desenha com o resultado mais recente e começa o envio
+    last_frame_us = now_us;
+    render();
+    ssd1306_send_begin(ssd);
+    sending = true;
+    return true;
+}
+
+uint32_t display_wait_us(uint32_t now_us) {
+    if (!ssd || (!sending && !dirty)) return UINT32_MAX;
+    uint32_t since = now_us - last_frame_us;
+    if (sending || since >= min_interval_us) return 0;
+    return min_interval_us - since;
+}
+
+void display_report(void) {
+    printf("DISPLAY,%lu,%s,%lu,%lu\n", (unsigned long)(min_interval_us ? 1000000u / min_interval_us : 0),
+           mode == DISPLAY_MODE_STATS ? "STATS" : "SAMPLE", (unsigned long)frames, (unsigned long)coalesced);
+}
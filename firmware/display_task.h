@@ -0,0 +1,43 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+// Atualização do display desacoplada da inferência
+// A inferência só publica o resultado (display_post, custo de uma cópia); o
+// display_poll, chamado pelo loop principal (tarefa do escalonador),
+// redesenha no máximo CNN_DISPLAY_FPS vezes por segundo com o resultado mais
+// recente (os intermediários são descartados) e manda a tela pro SSD1306 em
+// pedaços de DISPLAY_CHUNK_BYTES, um por chamada, pra não segurar a recepção
+// Com fps 0 volta ao comportamento antigo: desenha e envia inteiro a cada resultado
+
+#ifndef CNN_DISPLAY_FPS
+#define CNN_DISPLAY_FPS 5
+#endif
+
+#define DISPLAY_CHUNK_BYTES 32  // ~0.8 ms de I2C a 400 kHz por chamada
+#define DISPLAY_ROLLING 64      // amostras na média móvel do modo STATS
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    DISPLAY_MODE_SAMPLE,  // top 3 da última amostra (tela original)
+    DISPLAY_MODE_STATS,   // acurácia e vazão móveis + última predição
+} display_mode_t;
+
+void display_task_init(ssd1306_t* ssd);  // começa a enviar o que já está no buffer
+void display_post(const float* probs, uint8_t label, int pred, uint32_t now_us);
+bool display_poll(uint32_t now_us);  // true se mexeu no display nessa chamada
+// Quanto falta pro display_poll ter trabalho: 0 = já tem, UINT32_MAX = só depois de um display_post
+uint32_t display_wait_us(uint32_t now_us);
+
+void display_set_fps(uint32_t fps);
+void display_set_mode(display_mode_t mode);
+// Imprime DISPLAY,<fps>,<SAMPLE|STATS>,<quadros>,<resultados descartados>
+void display_report(void);
+
+#ifdef __cplusplus
+}
+#endif
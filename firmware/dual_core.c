@@ -0,0 +1,69 @@
+#include "dual_core.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "tflm_wrapper.h"
+#include "telemetry.h"
+
+// Pedido em andamento: escrito pelo core0 antes de job_ready e pelo core1 antes de
+// job_done. O aviso não passa pela FIFO: ela é do multicore_lockout (model_store.c),
+// cujo handler no core1 descarta qualquer outra palavra. Flags + SEV/WFE no lugar
+typedef struct {
+    const int8_t* input;
+    int8_t* logits;
+    int rc;
+    uint32_t invoke_us;
+} dual_job_t;
+
+static dual_job_t job;
+static bool busy = false;  // só o core0 mexe
+static volatile bool job_ready = false;  // core0 -> core1
+static volatile bool job_done = false;   // core1 -> core0
+
+// Loop do core1: o trace vai pro ring dele, a telemetria fica com o core0
+static void core1_main(void) {
+    multicore_lockout_victim_init();  // o core0 pode parar este núcleo pra gravar a flash (model_store.c)
+    for (;;) {
+        while (!job_ready) __wfe();  // o evento fica guardado se o SEV vier antes do WFE
+        job_ready = false;
+        __dmb();
+        uint32_t t0 = time_us_32();
+        TRACE_BEGIN_AT(TELEM_INVOKE, t0);
+        job.rc = tflm_invoke_instance(1, job.input, job.logits);
+        uint32_t t1 = time_us_32();
+        TRACE_END_AT(TELEM_INVOKE, t1);
+        job.invoke_us = t1 - t0;
+        __dmb();
+        job_done = true;
+        __sev();  // acorda o core0 se estiver dormindo no escalonador
+    }
+}
+
+void dual_core_start(void) {
+    multicore_launch_core1(core1_main);
+}
+
+bool dual_core_busy(void) {
+    return busy;
+}
+
+bool dual_core_submit(const int8_t* input, int8_t* logits) {
+    if (busy) return false;
+    job.input = input;
+    job.logits = logits;
+    busy = true;
+    __dmb();
+    job_ready = true;
+    __sev();
+    return true;
+}
+
+bool dual_core_poll(int* rc, uint32_t* invoke_us) {
+    if (!busy || !job_done) return false;
+    __dmb();
+    job_done = false;
+    busy = false;
+    *rc = job.rc;
+    *invoke_us = job.invoke_us;
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Inferência no core1 (CNN_DUAL_CORE): o core1 fica num loop esperando uma amostra
+// (flag compartilhada + SEV/WFE; a FIFO entre núcleos é do multicore_lockout da
+// gravação da flash), roda a instância 1 do TFLM e devolve o resultado do mesmo jeito. Um pedido por vez (uma instância no core1); quem decide a ordem é o
+// core0, que continua recebendo a serial e rodando a instância 0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void dual_core_start(void);  // lança o core1 (depois do tflm_init)
+bool dual_core_busy(void);   // tem pedido em andamento
+
+// Manda input (int8[784]) pro core1; logits (int8[10]) só pode ser lido depois
+// do dual_core_poll devolver true. Falha (false) se já tiver pedido em andamento
+bool dual_core_submit(const int8_t* input, int8_t* logits);
+
+// Não bloqueia: true se o pedido terminou, com o código do invoke e o tempo dele no core1
+bool dual_core_poll(int* rc, uint32_t* invoke_us);
+
+#ifdef __cplusplus
+}
+#endif
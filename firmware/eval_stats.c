@@ -0,0 +1,44 @@
+#include "eval_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+void eval_reset(eval_stats_t* ev) {
+    memset(ev, 0, sizeof(*ev));
+}
+
+void eval_add(eval_stats_t* ev, int label, int pred, uint32_t now_us) {
+    if (label < 0 || label >= EVAL_CLASSES || pred < 0 || pred >= EVAL_CLASSES) return;
+    if (ev->total == 0) ev->first_us = now_us;
+    ev->last_us = now_us;
+    ev->cm[label][pred]++;
+    ev->total++;
+    if (label == pred) ev->correct++;
+}
+
+// Razão em milésimos sem float (0 quando o denominador é zero)
+static uint32_t ratio_x1000(uint32_t num, uint32_t den) {
+    return den ? (uint32_t)(((uint64_t)num * 1000u + den / 2) / den) : 0;
+}
+
+void eval_dump(const eval_stats_t* ev) {
+    uint32_t elapsed_us = ev->last_us - ev->first_us;  // aritmética modular cobre o wrap do timer
+    uint32_t rate_x10 = elapsed_us ? (uint32_t)(((uint64_t)(ev->total - 1) * 10000000u) / elapsed_us) : 0;
+    printf("E,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)ev->total, (unsigned long)ev->correct,
+           (unsigned long)ratio_x1000(ev->correct, ev->total), (unsigned long)(elapsed_us / 1000),
+           (unsigned long)rate_x10);
+    for (int r = 0; r < EVAL_CLASSES; r++) {
+        printf("M,%d", r);
+        for (int c = 0; c < EVAL_CLASSES; c++) printf(",%lu", (unsigned long)ev->cm[r][c]);
+        printf("\n");
+    }
+    for (int k = 0; k < EVAL_CLASSES; k++) {
+        uint32_t row = 0, col = 0;  // row = reais da classe, col = preditos como a classe
+        for (int j = 0; j < EVAL_CLASSES; j++) {
+            row += ev->cm[k][j];
+            col += ev->cm[j][k];
+        }
+        printf("P,%d,%lu,%lu\n", k, (unsigned long)ratio_x1000(ev->cm[k][k], col),
+               (unsigned long)ratio_x1000(ev->cm[k][k], row));
+    }
+    printf("E,END\n");
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Avaliação contínua no device: matriz de confusão 10x10 em memória constante
+// (~420 bytes), alimentada amostra a amostra sem imprimir nada por amostra
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVAL_CLASSES 10
+
+typedef struct {
+    uint32_t cm[EVAL_CLASSES][EVAL_CLASSES];  // cm[real][predito]
+    uint32_t total;
+    uint32_t correct;
+    uint32_t first_us;  // timestamp da primeira amostra (pra taxa sustentada)
+    uint32_t last_us;   // timestamp da última amostra
+} eval_stats_t;
+
+void eval_reset(eval_stats_t* ev);
+void eval_add(eval_stats_t* ev, int label, int pred, uint32_t now_us);
+
+// Imprime o resumo compacto:
+//   E,<n>,<acertos>,<acc_x1000>,<tempo_ms>,<amostras/s_x10>
+//   M,<real>,<c0>,...,<c9>            (10 linhas, colunas = predito)
+//   P,<classe>,<precision_x1000>,<recall_x1000>  (10 linhas)
+//   E,END
+void eval_dump(const eval_stats_t* ev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,24 +1,27 @@
 #include "ssd1306.h"
 #include "font.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "hardware/i2c.h"
 
 // Inicializa a estrutura do display SSD1306
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c, uint8_t *buffer) {
     ssd->width = width;
     ssd->height = height;
     ssd->pages = height / 8;
     ssd->address = address;
     ssd->i2c_port = i2c;
-    ssd->bufsize = ssd->pages * ssd->width + 1;
+    ssd->bufsize = SSD1306_BUFSIZE(width, height);
     
-    // Aloca buffer de dados
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    // Buffer de dados vem de quem chama (pool estático, sem calloc)
+    ssd->ram_buffer = buffer;
     if (ssd->ram_buffer == NULL) {
         // Em caso de falha, poderia adicionar tratamento de erro (ex.: log ou loop infinito)
         while (1);
     }
+    memset(ssd->ram_buffer, 0, ssd->bufsize);
+    ssd->send_pos = 0;
     
     // Inicializa buffers
     ssd->ram_buffer[0] = 0x40; // Prefixo de dados
@@ -71,6 +74,35 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false);
 }
 
+// Define a janela da tela inteira; os dados vão depois em ssd1306_send_step
+void ssd1306_send_begin(ssd1306_t *ssd) {
+    ssd1306_command(ssd, 0x21); // Define endereço de coluna
+    ssd1306_command(ssd, 0);
+    ssd1306_command(ssd, ssd->width - 1);
+    ssd1306_command(ssd, 0x22); // Define endereço de página
+    ssd1306_command(ssd, 0);
+    ssd1306_command(ssd, ssd->pages - 1);
+    ssd->send_pos = 1;  // ram_buffer[0] é o prefixo de dados
+}
+
+// Manda o próximo pedaço; o ponteiro de endereço do display continua de onde parou
+bool ssd1306_send_step(ssd1306_t *ssd, uint16_t max_bytes) {
+    if (ssd->send_pos == 0) return true;
+    uint16_t n = ssd->bufsize - ssd->send_pos;
+    if (n > max_bytes) n = max_bytes;
+    // Cada transação precisa do byte de controle 0x40 na frente: usa o byte
+    // anterior do buffer como prefixo e restaura depois
+    uint8_t *chunk = ssd->ram_buffer + ssd->send_pos - 1;
+    uint8_t saved = chunk[0];
+    chunk[0] = 0x40;
+    i2c_write_blocking(ssd->i2c_port, ssd->address, chunk, n + 1, false);
+    chunk[0] = saved;
+    ssd->send_pos += n;
+    if (ssd->send_pos < ssd->bufsize) return false;
+    ssd->send_pos = 0;
+    return true;
+}
+
 // Desenha um pixel no buffer
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
     if (x >= ssd->width || y >= ssd->height) return; // Verifica limites
@@ -6,6 +6,9 @@
 #include <stdbool.h>
 #include "hardware/i2c.h"
 
+// Bytes do buffer de tela: 1 prefixo de dados + 1 bit por pixel
+#define SSD1306_BUFSIZE(width, height) ((width) * ((height) / 8) + 1)
+
 // Estrutura principal do display SSD1306
 typedef struct {
     uint8_t width, height, pages, address;
@@ -13,16 +16,22 @@ typedef struct {
     uint16_t bufsize;
     uint8_t *ram_buffer;
     uint8_t port_buffer[2];
+    uint16_t send_pos;  // próximo byte do envio em pedaços (0 = nenhum envio em andamento)
 } ssd1306_t;
 
 // Inicialização e configuração
+// buffer: SSD1306_BUFSIZE(width, height) bytes fornecidos por quem chama (sem heap)
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height,
-                  bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+                  bool external_vcc, uint8_t address, i2c_inst_t *i2c, uint8_t *buffer);
 void ssd1306_config(ssd1306_t *ssd);
 
 // Comunicação I2C
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+// Envio em pedaços: begin define a janela; cada step manda até max_bytes da tela
+// e retorna true quando terminou (o buffer não pode ser redesenhado no meio)
+void ssd1306_send_begin(ssd1306_t *ssd);
+bool ssd1306_send_step(ssd1306_t *ssd, uint16_t max_bytes);
 
 // Funções de desenho básicas
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
@@ -0,0 +1,76 @@
+#include "mem_pool.h"
+#include <stdalign.h>
+#include <stdio.h>
+
+_Static_assert(MEM_POOL_REQUIRED <= MEM_POOL_SIZE,
+               "consumidores do MEM_POOL_LIST não cabem no pool: aumente CNN_MEM_POOL_KB");
+
+alignas(16) static uint8_t pool[MEM_POOL_SIZE];
+static size_t pool_used = 0;
+static int32_t offsets[MEM_CONSUMER_COUNT];  // offset+1 de cada bloco (0 = não alocado)
+
+#define MEM_POOL_INFO(id, name, bytes, align) { name, (size_t)(bytes), (align) },
+static const struct {
+    const char* name;
+    size_t bytes;
+    size_t align;
+} consumers[MEM_CONSUMER_COUNT] = {
+    MEM_POOL_LIST(MEM_POOL_INFO)
+};
+#undef MEM_POOL_INFO
+
+// Mapa do build: o mesmo MEM_POOL_LIST vira texto numa seção que não vai pra flash
+// (.mem_pool_map); o CMake extrai do .elf depois do link e imprime. Os números são
+// constantes do compilador, então o mapa do build e o _Static_assert não divergem
+#define MEM_POOL_MAP_LINE(id, name, bytes, align)                                                \
+    __asm__ volatile(".pushsection .mem_pool_map,\"\",%%progbits\n"                             \
+                     ".ascii \"mem_pool: " name " %c0 B, alinhamento %c1\\n\"\n"          \
+                     ".popsection" ::"i"((size_t)(bytes)), "i"((size_t)(align)));
+__attribute__((used)) void mem_pool_build_map(void) {
+    MEM_POOL_LIST(MEM_POOL_MAP_LINE)
+    __asm__ volatile(".pushsection .mem_pool_map,\"\",%%progbits\n"
+                     ".ascii \"mem_pool: total %c0 B, pior caso %c1 B, folga %c2 B\\n\"\n"
+                     ".popsection" ::"i"(MEM_POOL_SIZE), "i"(MEM_POOL_REQUIRED),
+                     "i"(MEM_POOL_SIZE - MEM_POOL_REQUIRED));
+}
+#undef MEM_POOL_MAP_LINE
+
+void* mem_pool_alloc(mem_consumer_t id) {
+    if (id >= MEM_CONSUMER_COUNT) return NULL;
+    if (offsets[id]) return &pool[offsets[id] - 1];
+    size_t align = consumers[id].align;
+    size_t start = (pool_used + align - 1) & ~(align - 1);
+    if (start + consumers[id].bytes > MEM_POOL_SIZE) return NULL;
+    pool_used = start + consumers[id].bytes;
+    offsets[id] = (int32_t)start + 1;
+    return &pool[start];
+}
+
+size_t mem_pool_used(void) {
+    return pool_used;
+}
+
+#if PICO_ON_DEVICE
+#include <malloc.h>
+#include "hardware/regs/addressmap.h"
+extern char end;          // fim do .bss (linker script do SDK)
+extern char __HeapLimit;  // fim da RAM principal
+#endif
+
+void mem_pool_report(void) {
+    for (int i = 0; i < MEM_CONSUMER_COUNT; i++) {
+        printf("MEM,%s,%ld,%lu\n", consumers[i].name, (long)offsets[i] - 1, (unsigned long)consumers[i].bytes);
+    }
+    printf("MEM,POOL,%lu,%lu,%lu\n", (unsigned long)MEM_POOL_SIZE, (unsigned long)pool_used,
+           (unsigned long)(MEM_POOL_SIZE - pool_used));
+    printf("MEM,ARENA,%d,%d\n", tflm_arena_used_bytes(), TFLM_ARENA_SIZE);
+#if CNN_DUAL_CORE
+    printf("MEM,ARENA1,%d,%d\n", tflm_instance_arena_used_bytes(1), TFLM_ARENA_SIZE);
+#endif
+#if PICO_ON_DEVICE
+    struct mallinfo mi = mallinfo();
+    printf("MEM,SRAM,%lu,%lu,%lu\n", (unsigned long)(&end - (char*)SRAM_BASE),
+           (unsigned long)(&__HeapLimit - &end), (unsigned long)mi.uordblks);
+#endif
+    printf("MEM,END\n");
+}
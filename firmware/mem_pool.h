@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "tflm_wrapper.h"
+#include "trace.h"
+#include "serial_proto.h"
+#include "mnist_codec.h"
+#include "ssd1306.h"
+
+// Pool estático único pros buffers de longa duração: nada de heap em runtime
+// Cada consumidor é declarado aqui (nome, bytes, alinhamento) e pega seu bloco
+// uma vez no boot com mem_pool_alloc(); não existe free.
+// O tamanho total vem do build (CNN_MEM_POOL_KB) e o build falha se a soma dos
+// consumidores não couber, então a folga (headroom) é conhecida antes de gravar.
+
+#ifndef CNN_MEM_POOL_KB
+#define CNN_MEM_POOL_KB 136
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEM_POOL_SIZE ((size_t)CNN_MEM_POOL_KB * 1024)
+
+#define DISPLAY_WIDTH  128
+#define DISPLAY_HEIGHT 64
+
+// Arena do segundo interpretador (core1), só com CNN_DUAL_CORE
+#if CNN_DUAL_CORE
+#define MEM_POOL_DUAL(X) X(TENSOR_ARENA1, "tensor_arena1", TFLM_ARENA_SIZE, 16)
+#else
+#define MEM_POOL_DUAL(X)
+#endif
+
+// Mapa de memória: X(id, nome, bytes, alinhamento)
+#define MEM_POOL_LIST(X) \
+    X(TENSOR_ARENA, "tensor_arena", TFLM_ARENA_SIZE, 16)                                   \
+    MEM_POOL_DUAL(X)                                                                       \
+    X(TRACE_RINGS,  "trace_rings",  TRACE_POOL_BYTES, 4)                                   \
+    X(INPUT_SPARES, "input_spares", (size_t)(PROTO_WINDOW - 1) * CODEC_PIXELS, 4)          \
+    X(DISPLAY,      "ssd1306",      SSD1306_BUFSIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT), 4)
+
+#define MEM_POOL_ENUM(id, name, bytes, align) MEM_##id,
+typedef enum {
+    MEM_POOL_LIST(MEM_POOL_ENUM)
+    MEM_CONSUMER_COUNT
+} mem_consumer_t;
+#undef MEM_POOL_ENUM
+
+// Pior caso: cada bloco pode perder (alinhamento - 1) bytes de padding
+#define MEM_POOL_NEED(id, name, bytes, align) + (size_t)(bytes) + (align) - 1
+#define MEM_POOL_REQUIRED (0 MEM_POOL_LIST(MEM_POOL_NEED))
+
+void* mem_pool_alloc(mem_consumer_t id);  // bloco do consumidor (o mesmo se chamar de novo), NULL se não couber
+size_t mem_pool_used(void);
+
+// Relatório pela serial:
+//   MEM,<consumidor>,<offset>,<bytes>     (offset -1 = ainda não alocado)
+//   MEM,POOL,<total>,<usado>,<livre>
+//   MEM,ARENA,<usado_tflm>,<tamanho>      (quanto da arena o modelo realmente ocupa)
+//   MEM,ARENA1,<usado_tflm>,<tamanho>     (segunda instância, só com CNN_DUAL_CORE)
+//   MEM,SRAM,<estático>,<livre>,<heap>    (só no device: .data+.bss, RAM após o .bss, heap em uso)
+//   MEM,END
+void mem_pool_report(void);
+
+#ifdef __cplusplus
+}
+#endif
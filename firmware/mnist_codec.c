@@ -0,0 +1,312 @@
+#include "mnist_codec.h"
+#include <string.h>
+#include <stddef.h>
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Lê n dígitos hex; retorna -1 se algum não for hex
+static int read_hex(const char* p, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        int d = hex_value(p[i]);
+        if (d < 0) return -1;
+        v = (v << 4) | d;
+    }
+    return v;
+}
+
+// Decodifica run-length: zeros em corrida, pixels não nulos literais
+int codec_decode_rle(const char* data, uint8_t* pixels) {
+    const char* p = data;
+    int pos = 0;
+    while (*p && pos < CODEC_PIXELS) {
+        int run = 0;
+        if (*p >= 'g' && *p <= 'z') {
+            run = *p - 'g' + 1;  // corrida curta de 1..20 zeros
+            p++;
+        } else if (*p == 'Z') {
+            run = read_hex(p + 1, 2);  // corrida longa de 1..255 zeros
+            if (run <= 0) return -1;
+            p += 3;
+        } else {
+            int v = read_hex(p, 2);
+            if (v < 0) return -1;
+            pixels[pos++] = (uint8_t)v;
+            p += 2;
+            continue;
+        }
+        if (pos + run > CODEC_PIXELS) return -1;
+        for (int i = 0; i < run; i++) pixels[pos++] = 0;
+    }
+    return (pos == CODEC_PIXELS && *p == '\0') ? 0 : -1;
+}
+
+// Decodifica pares índice:valor; a imagem começa zerada
+int codec_decode_sparse(const char* data, uint8_t* pixels) {
+    for (int i = 0; i < CODEC_PIXELS; i++) pixels[i] = 0;
+    const char* p = data;
+    while (*p) {
+        int idx = read_hex(p, 3);
+        if (idx < 0 || idx >= CODEC_PIXELS) return -1;
+        int v = read_hex(p + 3, 2);
+        if (v < 0) return -1;
+        pixels[idx] = (uint8_t)v;
+        p += 5;
+    }
+    return 0;
+}
+
+static void stream_emit(codec_stream_t* st, int idx, int value) {
+    st->out[idx] = st->lut ? st->lut[value] : (int8_t)(uint8_t)value;
+}
+
+int codec_decode_packed(const uint8_t* data, int len, int8_t* out, const int8_t* lut) {
+    const int8_t zero = lut ? lut[0] : 0;
+    int pos = 0, i = 0;
+    while (pos < CODEC_PIXELS) {
+        if (i >= len) return -1;
+        uint8_t b = data[i++];
+        if (b < 0x80) {  // corrida de zeros
+            int run = b + 1;
+            if (pos + run > CODEC_PIXELS) return -1;
+            for (int k = 0; k < run; k++) out[pos++] = zero;
+        } else {         // literais
+            int n = b - 0x7F;
+            if (pos + n > CODEC_PIXELS || i + n > len) return -1;
+            for (int k = 0; k < n; k++, i++) out[pos++] = lut ? lut[data[i]] : (int8_t)data[i];
+        }
+    }
+    return i;
+}
+
+void codec_stream_begin(codec_stream_t* st, char enc, int8_t* out, const int8_t* lut) {
+    st->enc = enc;
+    st->error = false;
+    st->ndig = 0;
+    st->acc = 0;
+    st->pos = 0;
+    st->index = 0;
+    st->out = out;
+    st->lut = lut;
+    if (enc == CODEC_SPARSE) {
+        // pixels não listados são zero
+        for (int i = 0; i < CODEC_PIXELS; i++) stream_emit(st, i, 0);
+    } else if (enc != CODEC_CSV && enc != CODEC_RLE) {
+        st->error = true;
+    }
+}
+
+// CSV: números decimais separados por vírgula/espaço; valores > 255 saturam
+// e campos além do 784º são ignorados (mesmo comportamento do parser antigo)
+static void stream_put_csv(codec_stream_t* st, char c) {
+    if (c >= '0' && c <= '9') {
+        st->acc = (uint16_t)(st->acc * 10 + (c - '0'));
+        if (st->acc > 255) st->acc = 255;
+        st->ndig++;
+        return;
+    }
+    if (c != ',' && c != ' ') {
+        st->error = true;
+        return;
+    }
+    if (st->ndig == 0) return;
+    if (st->pos < CODEC_PIXELS) stream_emit(st, st->pos, st->acc);
+    st->pos++;
+    st->acc = 0;
+    st->ndig = 0;
+}
+
+static void stream_put_rle(codec_stream_t* st, char c) {
+    if (st->ndig == 0 && c >= 'g' && c <= 'z') {
+        int run = c - 'g' + 1;
+        if (st->pos + run > CODEC_PIXELS) {
+            st->error = true;
+            return;
+        }
+        for (int i = 0; i < run; i++) stream_emit(st, st->pos++, 0);
+        return;
+    }
+    if (st->ndig == 0 && c == 'Z') {
+        st->ndig = 0x80;  // marca "lendo tamanho de corrida longa"
+        st->acc = 0;
+        return;
+    }
+    int d = hex_value(c);
+    if (d < 0) {
+        st->error = true;
+        return;
+    }
+    bool long_run = (st->ndig & 0x80) != 0;
+    st->acc = (uint16_t)((st->acc << 4) | d);
+    st->ndig++;
+    if ((st->ndig & 0x7F) < 2) return;
+    if (long_run) {
+        if (st->acc == 0 || st->pos + st->acc > CODEC_PIXELS) {
+            st->error = true;
+            return;
+        }
+        for (int i = 0; i < st->acc; i++) stream_emit(st, st->pos++, 0);
+    } else {
+        if (st->pos >= CODEC_PIXELS) {
+            st->error = true;
+            return;
+        }
+        stream_emit(st, st->pos++, st->acc);
+    }
+    st->acc = 0;
+    st->ndig = 0;
+}
+
+static void stream_put_sparse(codec_stream_t* st, char c) {
+    int d = hex_value(c);
+    if (d < 0) {
+        st->error = true;
+        return;
+    }
+    st->acc = (uint16_t)((st->acc << 4) | d);
+    st->ndig++;
+    if (st->ndig == 3) {
+        if (st->acc >= CODEC_PIXELS) {
+            st->error = true;
+            return;
+        }
+        st->index = st->acc;
+        st->acc = 0;
+    } else if (st->ndig == 5) {
+        stream_emit(st, st->index, st->acc);
+        st->pos++;
+        st->acc = 0;
+        st->ndig = 0;
+    }
+}
+
+void codec_stream_put(codec_stream_t* st, char c) {
+    if (st->error) return;
+    switch (st->enc) {
+        case CODEC_CSV:    stream_put_csv(st, c); break;
+        case CODEC_RLE:    stream_put_rle(st, c); break;
+        case CODEC_SPARSE: stream_put_sparse(st, c); break;
+        default:           st->error = true; break;
+    }
+}
+
+int codec_stream_end(codec_stream_t* st) {
+    if (st->enc == CODEC_CSV && !st->error) stream_put_csv(st, ',');  // fecha o último número
+    if (st->error) return -1;
+    switch (st->enc) {
+        case CODEC_CSV:    return (st->pos >= CODEC_PIXELS) ? 0 : -1;
+        case CODEC_RLE:    return (st->pos == CODEC_PIXELS && st->ndig == 0) ? 0 : -1;
+        case CODEC_SPARSE: return (st->ndig == 0) ? 0 : -1;
+        default:           return -1;
+    }
+}
+
+// Escreve um char se couber; com out NULL só conta o tamanho
+static void put(char* out, int cap, int* len, char c) {
+    if (out && *len < cap) out[*len] = c;
+    (*len)++;
+}
+
+static int finish(char* out, int cap, int len) {
+    if (!out) return len;
+    if (len >= cap) return -1;  // precisa de espaço pro '\0'
+    out[len] = '\0';
+    return len;
+}
+
+int codec_encode_rle(const uint8_t* pixels, char* out, int cap) {
+    int len = 0;
+    int i = 0;
+    while (i < CODEC_PIXELS) {
+        if (pixels[i] != 0) {
+            put(out, cap, &len, hex_digits[pixels[i] >> 4]);
+            put(out, cap, &len, hex_digits[pixels[i] & 0x0F]);
+            i++;
+            continue;
+        }
+        int run = 0;
+        while (i + run < CODEC_PIXELS && pixels[i + run] == 0 && run < 255) run++;
+        if (run <= 20) {
+            put(out, cap, &len, (char)('g' + run - 1));
+        } else {
+            put(out, cap, &len, 'Z');
+            put(out, cap, &len, hex_digits[run >> 4]);
+            put(out, cap, &len, hex_digits[run & 0x0F]);
+        }
+        i += run;
+    }
+    return finish(out, cap, len);
+}
+
+int codec_encode_sparse(const uint8_t* pixels, char* out, int cap) {
+    int len = 0;
+    for (int i = 0; i < CODEC_PIXELS; i++) {
+        if (pixels[i] == 0) continue;
+        put(out, cap, &len, hex_digits[(i >> 8) & 0x0F]);
+        put(out, cap, &len, hex_digits[(i >> 4) & 0x0F]);
+        put(out, cap, &len, hex_digits[i & 0x0F]);
+        put(out, cap, &len, hex_digits[pixels[i] >> 4]);
+        put(out, cap, &len, hex_digits[pixels[i] & 0x0F]);
+    }
+    return finish(out, cap, len);
+}
+
+int codec_encode_csv(const uint8_t* pixels, char* out, int cap) {
+    int len = 0;
+    for (int i = 0; i < CODEC_PIXELS; i++) {
+        if (i > 0) put(out, cap, &len, ',');
+        int v = pixels[i];
+        if (v >= 100) put(out, cap, &len, (char)('0' + v / 100));
+        if (v >= 10) put(out, cap, &len, (char)('0' + (v / 10) % 10));
+        put(out, cap, &len, (char)('0' + v % 10));
+    }
+    return finish(out, cap, len);
+}
+
+int codec_encode_packed(const uint8_t* pixels, uint8_t* out, int cap) {
+    int len = 0;
+    int i = 0;
+    while (i < CODEC_PIXELS) {
+        int n = 0;
+        if (pixels[i] == 0) {
+            while (i + n < CODEC_PIXELS && pixels[i + n] == 0 && n < 128) n++;
+            if (out && len < cap) out[len] = (uint8_t)(n - 1);
+            len++;
+        } else {
+            // Literais até dois zeros seguidos: um zero solto sai mais barato no meio deles
+            while (i + n < CODEC_PIXELS && n < 128 &&
+                   !(pixels[i + n] == 0 && (i + n + 1 == CODEC_PIXELS || pixels[i + n + 1] == 0))) n++;
+            if (out && len + 1 + n <= cap) {
+                out[len] = (uint8_t)(0x7F + n);
+                memcpy(out + len + 1, pixels + i, (size_t)n);
+            }
+            len += 1 + n;
+        }
+        i += n;
+    }
+    return (out && len > cap) ? -1 : len;
+}
+
+int codec_encode_best(const uint8_t* pixels, char* out, int cap, char* encoding) {
+    // Mede as três sem escrever e só codifica a vencedora
+    int n_csv = codec_encode_csv(pixels, NULL, 0);
+    int n_rle = codec_encode_rle(pixels, NULL, 0);
+    int n_sparse = codec_encode_sparse(pixels, NULL, 0);
+    if (n_rle <= n_sparse && n_rle < n_csv) {
+        *encoding = CODEC_RLE;
+        return codec_encode_rle(pixels, out, cap);
+    }
+    if (n_sparse < n_csv) {
+        *encoding = CODEC_SPARSE;
+        return codec_encode_sparse(pixels, out, cap);
+    }
+    *encoding = CODEC_CSV;
+    return codec_encode_csv(pixels, out, cap);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+// Codificações compactas da imagem 28x28 pro protocolo serial
+//
+// 'R' (run-length): sequência de tokens até completar 784 pixels
+//   hh      pixel literal (2 dígitos hex)
+//   g..z    corrida de 1..20 zeros
+//   Zhh     corrida de 1..255 zeros
+// 'S' (esparso): pares iiivv concatenados (índice em 3 hex + valor em 2 hex),
+//   pixels não listados ficam em zero
+// Binário (amostras do autoteste na flash, não passa pela serial): bytes até
+//   completar 784 pixels; 0x00..0x7F corrida de 1..128 zeros, 0x80..0xFF 1..128
+//   pixels literais logo em seguida
+//
+// Ficam em C puro (sem SDK) pra serem usadas também pelas ferramentas do host
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CODEC_PIXELS 784
+
+#define CODEC_CSV    'C'
+#define CODEC_RLE    'R'
+#define CODEC_SPARSE 'S'
+
+// Decodificadores: escrevem direto em pixels[784], retornam 0 se OK, -1 se erro
+int codec_decode_rle(const char* data, uint8_t* pixels);
+int codec_decode_sparse(const char* data, uint8_t* pixels);
+
+// Decodificador em streaming: recebe um char por vez (só os pixels, sem label) e
+// escreve out[i] = lut[pixel] na hora, sem buffer intermediário da linha.
+// Com lut NULL escreve o valor cru (0..255 reinterpretado como int8)
+typedef struct {
+    char enc;           // CODEC_CSV, CODEC_RLE ou CODEC_SPARSE
+    bool error;
+    uint8_t ndig;       // dígitos acumulados no token atual
+    uint16_t acc;       // valor do token atual
+    uint16_t pos;       // próximo pixel (CSV/RLE) ou índice lido (esparso)
+    uint16_t index;     // índice do par atual (esparso)
+    int8_t* out;
+    const int8_t* lut;
+} codec_stream_t;
+
+void codec_stream_begin(codec_stream_t* st, char enc, int8_t* out, const int8_t* lut);
+void codec_stream_put(codec_stream_t* st, char c);
+int codec_stream_end(codec_stream_t* st);  // 0 se a imagem veio completa e válida
+
+// Decodifica uma imagem binária de data[0..len) direto em out[i] = lut[pixel]
+// (lut NULL = valor cru); retorna os bytes consumidos ou -1 se malformada
+int codec_decode_packed(const uint8_t* data, int len, int8_t* out, const int8_t* lut);
+
+// Codificadores (lado do host): retornam o tamanho escrito sem o '\0', ou -1 se não couber
+int codec_encode_rle(const uint8_t* pixels, char* out, int cap);
+int codec_encode_sparse(const uint8_t* pixels, char* out, int cap);
+int codec_encode_csv(const uint8_t* pixels, char* out, int cap);
+// Binário: retorna o tamanho (sem terminador) ou -1 se não couber; out NULL só mede
+int codec_encode_packed(const uint8_t* pixels, uint8_t* out, int cap);
+
+// Escolhe a codificação mais curta pra amostra e escreve em out
+// Retorna o tamanho e devolve CODEC_CSV/RLE/SPARSE em *encoding
+int codec_encode_best(const uint8_t* pixels, char* out, int cap, char* encoding);
+
+#ifdef __cplusplus
+}
+#endif
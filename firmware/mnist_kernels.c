@@ -0,0 +1,50 @@
+#include "mnist_kernels.h"
+#include <math.h>
+
+int8_t quantize_f32_to_i8(float x, float scale, int zp) {
+    float q = (x / scale) + (float)zp;  // formula: q = x/scale + zero_point
+    if (q > 127.0f) q = 127.0f;         // clamp no range int8
+    if (q < -128.0f) q = -128.0f;
+    return (int8_t)q;
+}
+
+// Normalizar [0-255] -> [0-1] e quantizar pra int8 dá no máximo 256 resultados,
+// então a recepção só indexa a tabela
+void build_input_lut(int8_t lut[256], float scale, int zp) {
+    for (int p = 0; p < 256; p++) {
+        lut[p] = quantize_f32_to_i8((float)p / 255.0f, scale, zp);
+    }
+}
+
+void softmax_i8_to_probs(const int8_t* logits, float scale, int zero_point, float* probs, int n) {
+    float dequant[10];
+    float max_val = -1e9f;
+    // Primeiro dequantiza os logits int8 -> float
+    for (int i = 0; i < n; i++) {
+        dequant[i] = scale * ((float)logits[i] - (float)zero_point);  // x = scale * (q - zp)
+        if (dequant[i] > max_val) max_val = dequant[i];  // acha o max pra estabilidade numérica
+    }
+    // Softmax: exp(x - max) / sum(exp(x - max))
+    // Subtrair max evita overflow no exp()
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        dequant[i] = expf(dequant[i] - max_val);
+        sum += dequant[i];
+    }
+    // Normaliza e converte pra porcentagem
+    for (int i = 0; i < n; i++) {
+        probs[i] = (dequant[i] / sum) * 100.0f;
+    }
+}
+
+int argmax_i8(const int8_t* v, int n) {
+    int best = 0;
+    int8_t bestv = v[0];
+    for (int i = 1; i < n; i++) {
+        if (v[i] > bestv) {
+            bestv = v[i];
+            best = i;
+        }
+    }
+    return best;
+}
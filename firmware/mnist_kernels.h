@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+
+// Pré e pós-processamento da inferência: quantização da entrada, softmax e argmax
+// dos logits. Ficam em C puro (sem SDK) pra rodar igual no device e no host
+// (host/kernel_check compara toda implementação nova contra estas)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Converte float [0-1] pra int8 quantizado: q = x/scale + zero_point, truncado e saturado
+int8_t quantize_f32_to_i8(float x, float scale, int zp);
+
+// LUT pixel 0..255 -> int8: quantize_f32_to_i8(p/255) pra cada valor possível
+void build_input_lut(int8_t lut[256], float scale, int zp);
+
+// Logits int8 -> probabilidades em % (0-100); n <= 10
+void softmax_i8_to_probs(const int8_t* logits, float scale, int zero_point, float* probs, int n);
+
+// Índice do maior valor (no empate fica o primeiro)
+int argmax_i8(const int8_t* v, int n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,278 @@
+#include "model_store.h"
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#if CNN_DUAL_CORE
+#include "pico/multicore.h"
+#endif
+#include "serial_proto.h"
+#include "tflm_wrapper.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOT_BYTES   (CNN_MODEL_SLOT_KB * 1024)
+#define HDR_BYTES    FLASH_SECTOR_SIZE  // setor só do cabeçalho: o .tflite começa alinhado
+#define MODEL_MAX    (SLOT_BYTES - HDR_BYTES)
+#define STORE_OFFSET (PICO_FLASH_SIZE_BYTES - MODEL_STORE_SLOTS * SLOT_BYTES)
+#define MODEL_MAGIC  0x4D4E4E43u  // "CNNM"
+
+_Static_assert(SLOT_BYTES % FLASH_SECTOR_SIZE == 0, "CNN_MODEL_SLOT_KB tem que ser múltiplo de 4");
+
+#ifndef __flash_binary_end
+extern char __flash_binary_end;  // fim da imagem do firmware (linker script do SDK)
+#endif
+
+// Primeira página do slot; o resto do setor fica apagado
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;      // geração: entre os slots válidos, o maior seq é o mais novo
+    uint32_t size;     // bytes do .tflite
+    uint32_t crc;      // CRC-32 do .tflite
+    uint32_t hdr_crc;  // CRC-32 dos campos acima
+} model_hdr_t;
+
+// Upload em andamento (um por vez, sempre no slot que não está em uso)
+static struct {
+    int slot;  // -1 = nenhum
+    uint32_t size;
+    uint32_t crc;
+    uint32_t written;
+    uint8_t page[FLASH_PAGE_SIZE];  // a flash grava de página em página
+} up = {.slot = -1};
+
+static uint32_t slot_offset(int slot) {
+    return STORE_OFFSET + (uint32_t)slot * SLOT_BYTES;
+}
+
+static const model_hdr_t* slot_hdr(int slot) {
+    return (const model_hdr_t*)(XIP_BASE + slot_offset(slot));
+}
+
+static const uint8_t* slot_data(int slot) {
+    return (const uint8_t*)(XIP_BASE + slot_offset(slot) + HDR_BYTES);
+}
+
+static bool hdr_ok(const model_hdr_t* h) {
+    return h->magic == MODEL_MAGIC && h->size > 0 && h->size <= MODEL_MAX &&
+           proto_crc32(0, (const uint8_t*)h, offsetof(model_hdr_t, hdr_crc)) == h->hdr_crc;
+}
+
+static bool slot_valid(int slot) {
+    const model_hdr_t* h = slot_hdr(slot);
+    return hdr_ok(h) && proto_crc32(0, slot_data(slot), h->size) == h->crc;
+}
+
+// A partição não pode encostar na imagem do firmware (cresceu ou slot grande demais)
+static bool store_fits(void) {
+    return (uintptr_t)&__flash_binary_end <= XIP_BASE + STORE_OFFSET;
+}
+
+int model_store_get(int rank, const uint8_t** data, uint32_t* size) {
+    if (!store_fits()) return -1;
+    int order[MODEL_STORE_SLOTS];
+    int n = 0;
+    for (int s = 0; s < MODEL_STORE_SLOTS; s++) {
+        if (slot_valid(s)) order[n++] = s;
+    }
+    if (n == 2 && slot_hdr(order[1])->seq > slot_hdr(order[0])->seq) {
+        int t = order[0];
+        order[0] = order[1];
+        order[1] = t;
+    }
+    if (rank < 0 || rank >= n) return -1;
+    *data = slot_data(order[rank]);
+    *size = slot_hdr(order[rank])->size;
+    return order[rank];
+}
+
+// Apagar/gravar tira a flash do XIP: interrupções desligadas e, com dois núcleos,
+// o core1 parado num handler na RAM enquanto dura
+static uint32_t flash_lock(void) {
+#if CNN_DUAL_CORE
+    multicore_lockout_start_blocking();
+#endif
+    return save_and_disable_interrupts();
+}
+
+static void flash_unlock(uint32_t ints) {
+    restore_interrupts(ints);
+#if CNN_DUAL_CORE
+    multicore_lockout_end_blocking();
+#endif
+}
+
+// Um setor por vez, com as interrupções de volta entre eles (o USB não cai)
+static void store_erase(uint32_t offset, uint32_t bytes) {
+    for (uint32_t off = 0; off < bytes; off += FLASH_SECTOR_SIZE) {
+        uint32_t ints = flash_lock();
+        flash_range_erase(offset + off, FLASH_SECTOR_SIZE);
+        flash_unlock(ints);
+    }
+}
+
+static void store_program(uint32_t offset, const uint8_t* page) {
+    uint32_t ints = flash_lock();
+    flash_range_program(offset, page, FLASH_PAGE_SIZE);
+    flash_unlock(ints);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void store_report(void) {
+    uint32_t size = 0;
+    const uint8_t* data = tflm_model_data(&size);
+    int active = tflm_model_slot();
+    printf("MODEL,ACTIVE,%s,%d,%lu,%08lx\n", active >= 0 ? "FLASH" : "BUILTIN", active,
+           (unsigned long)size, (unsigned long)(data ? proto_crc32(0, data, size) : 0));
+    printf("MODEL,PARTITION,%lx,%d,%s\n", (unsigned long)STORE_OFFSET, SLOT_BYTES,
+           store_fits() ? "OK" : "OVERLAP");
+    for (int s = 0; s < MODEL_STORE_SLOTS; s++) {
+        const model_hdr_t* h = slot_hdr(s);
+        if (h->magic != MODEL_MAGIC) {
+            printf("MODEL,SLOT,%d,EMPTY,0,0,00000000\n", s);
+            continue;
+        }
+        printf("MODEL,SLOT,%d,%s,%lu,%lu,%08lx\n", s, slot_valid(s) ? "VALID" : "BAD",
+               (unsigned long)h->seq, (unsigned long)h->size, (unsigned long)h->crc);
+    }
+    if (up.slot >= 0) {
+        printf("MODEL,UPLOAD,%d,%lx,%lu\n", up.slot, (unsigned long)up.written, (unsigned long)up.size);
+    }
+    printf("MODEL,END\n");
+}
+
+// BEGIN <bytes> <crc32>: escolhe o slot que não está em uso e apaga
+static void cmd_begin(const char* arg) {
+    char* end;
+    unsigned long size = strtoul(arg, &end, 10);
+    unsigned long crc = strtoul(end, &end, 16);
+    if (size == 0 || size > MODEL_MAX) {
+        printf("ERR,MODEL,SIZE,%d\n", MODEL_MAX);
+        return;
+    }
+    if (!store_fits()) {
+        printf("ERR,MODEL,OVERLAP\n");
+        return;
+    }
+    // Nunca escreve no slot de onde o modelo atual está sendo lido
+    int active = tflm_model_slot();
+    const uint8_t* data;
+    uint32_t newest_size;
+    int newest = model_store_get(0, &data, &newest_size);
+    if (active >= 0) up.slot = active ^ 1;
+    else up.slot = newest >= 0 ? newest ^ 1 : 0;
+    up.size = (uint32_t)size;
+    up.crc = (uint32_t)crc;
+    up.written = 0;
+    store_erase(slot_offset(up.slot), HDR_BYTES + ((up.size + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1)));
+    printf("OK,MODEL,BEGIN,%d\n", up.slot);
+}
+
+// DATA <offset>,<hex>*<crc16>: o offset tem que ser o próximo byte esperado; se o
+// host reenviar um pedaço já aceito (resposta perdida) recebe o offset certo no ERR
+static void cmd_data(const char* arg) {
+    if (up.slot < 0) {
+        printf("ERR,MODEL,STATE\n");
+        return;
+    }
+    const char* star = strrchr(arg, '*');
+    if (!star || proto_crc16(arg, (int)(star - arg)) != (uint16_t)strtoul(star + 1, NULL, 16)) {
+        printf("ERR,MODEL,CRC\n");
+        return;
+    }
+    char* p;
+    unsigned long off = strtoul(arg, &p, 16);
+    if (*p != ',' || (star - p - 1) % 2 != 0) {
+        printf("ERR,MODEL,FMT\n");
+        return;
+    }
+    p++;
+    uint32_t n = (uint32_t)(star - p) / 2;
+    if (off != up.written) {
+        printf("ERR,MODEL,OFFSET,%lx\n", (unsigned long)up.written);
+        return;
+    }
+    if (up.written + n > up.size) {
+        printf("ERR,MODEL,SIZE,%lu\n", (unsigned long)up.size);
+        return;
+    }
+    for (const char* q = p; q < star; q++) {
+        if (hex_value(*q) < 0) {
+            printf("ERR,MODEL,FMT\n");
+            return;
+        }
+    }
+    uint32_t base = slot_offset(up.slot) + HDR_BYTES;
+    for (uint32_t i = 0; i < n; i++, p += 2) {
+        up.page[up.written % FLASH_PAGE_SIZE] = (uint8_t)(hex_value(p[0]) << 4 | hex_value(p[1]));
+        up.written++;
+        if (up.written % FLASH_PAGE_SIZE == 0) store_program(base + up.written - FLASH_PAGE_SIZE, up.page);
+    }
+    printf("OK,MODEL,DATA,%lx\n", (unsigned long)up.written);
+}
+
+// COMMIT: fecha a última página, confere o que ficou na flash e só então grava o
+// cabeçalho; o slot antigo continua válido até aqui
+static void cmd_commit(void) {
+    if (up.slot < 0 || up.written != up.size) {
+        printf("ERR,MODEL,STATE\n");
+        return;
+    }
+    int slot = up.slot;
+    up.slot = -1;
+    uint32_t tail = up.written % FLASH_PAGE_SIZE;
+    if (tail) {
+        memset(up.page + tail, 0xFF, FLASH_PAGE_SIZE - tail);
+        store_program(slot_offset(slot) + HDR_BYTES + up.written - tail, up.page);
+    }
+    if (proto_crc32(0, slot_data(slot), up.size) != up.crc) {
+        printf("ERR,MODEL,CRC32\n");
+        return;
+    }
+    int rc = tflm_model_check(slot_data(slot), up.size);
+    if (rc != 0) {
+        printf("ERR,MODEL,MODEL,%d\n", rc);
+        return;
+    }
+    uint32_t seq = 0;
+    for (int s = 0; s < MODEL_STORE_SLOTS; s++) {
+        if (s != slot && hdr_ok(slot_hdr(s)) && slot_hdr(s)->seq > seq) seq = slot_hdr(s)->seq;
+    }
+    model_hdr_t h = {MODEL_MAGIC, seq + 1, up.size, up.crc, 0};
+    h.hdr_crc = proto_crc32(0, (const uint8_t*)&h, offsetof(model_hdr_t, hdr_crc));
+    memset(up.page, 0xFF, FLASH_PAGE_SIZE);
+    memcpy(up.page, &h, sizeof(h));
+    store_program(slot_offset(slot), up.page);
+    printf("OK,MODEL,COMMIT,%d,%lu\n", slot, (unsigned long)h.seq);
+    // O interpretador já está montado em cima do modelo atual: reinicia pra trocar
+    // (os 100 ms dão tempo da resposta sair pelo USB)
+    watchdog_reboot(0, 0, 100);
+    while (1) tight_loop_contents();
+}
+
+void model_store_command(const char* cmd) {
+    while (*cmd == ' ') cmd++;
+    if (*cmd == '\0') {
+        store_report();
+    } else if (strncmp(cmd, "BEGIN ", 6) == 0) {
+        cmd_begin(cmd + 6);
+    } else if (strncmp(cmd, "DATA ", 5) == 0) {
+        cmd_data(cmd + 5);
+    } else if (strcmp(cmd, "COMMIT") == 0) {
+        cmd_commit();
+    } else if (strcmp(cmd, "CLEAR") == 0) {
+        up.slot = -1;
+        for (int s = 0; s < MODEL_STORE_SLOTS; s++) store_erase(slot_offset(s), HDR_BYTES);
+        printf("OK,MODEL,CLEAR\n");
+    } else {
+        printf("ERR,MODEL\n");
+    }
+}
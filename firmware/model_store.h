@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Partição de modelos na flash: dois slots (A/B) no fim da flash, cada um com um
+// setor de cabeçalho e o .tflite logo depois. O upload pela serial sempre escreve
+// no slot que não está em uso e só grava o cabeçalho depois de conferir o CRC, então
+// uma queda no meio deixa o slot antigo (ou o modelo embutido) intacto. No boot o
+// tflm_init tenta o slot válido mais novo, depois o outro, depois o embutido; o
+// modelo escolhido é lido direto da flash pelo XIP, sem cópia pra RAM.
+//
+// Comandos ($MODEL ...):
+//   $MODEL                                estado: MODEL,ACTIVE,... + MODEL,SLOT,... + MODEL,END
+//   $MODEL BEGIN <bytes> <crc32>          apaga o slot livre e começa um upload (crc32 em hex)
+//   $MODEL DATA <offset>,<hex>*<crc16>    um pedaço (offset em hex, dados em hex; crc16
+//                                         como nos frames, de tudo entre "DATA " e '*')
+//   $MODEL COMMIT                         confere tamanho, CRC-32 e o flatbuffer, grava o
+//                                         cabeçalho e reinicia com o modelo novo
+//   $MODEL CLEAR                          invalida os dois slots (volta pro embutido no boot)
+// Respostas: OK,MODEL,<etapa>,... ou ERR,MODEL,<motivo>
+
+#ifndef CNN_MODEL_SLOT_KB
+#define CNN_MODEL_SLOT_KB 64  // tamanho de cada slot, cabeçalho incluído (opção do CMake)
+#endif
+
+#define MODEL_STORE_SLOTS 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Modelo do slot de ordem rank (0 = mais novo, 1 = o outro) com cabeçalho e CRC-32
+// conferidos; devolve o índice do slot e o ponteiro XIP, ou -1 se não tiver
+int model_store_get(int rank, const uint8_t** data, uint32_t* size);
+
+// Trata "$MODEL ..." (cmd sem o '$')
+void model_store_command(const char* cmd);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,68 @@
+#include "selftest.h"
+#include "tflm_wrapper.h"
+#include "mnist_kernels.h"
+#include "serial_proto.h"
+#include "mnist_codec.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include "selftest_data.h"
+
+#define SELFTEST_CLASSES 10
+
+void selftest_run(selftest_result_t* res) {
+    res->total = res->correct = res->us = res->us_max = res->crc = 0;
+    res->status = SELFTEST_ERR_INVOKE;
+    tflm_ctx_t* ctx = tflm_ctx_default();
+    if (!ctx) return;
+    int8_t lut[256];
+    build_input_lut(lut, tflm_ctx_input_scale(ctx), tflm_ctx_input_zero_point(ctx));
+    const int batch = tflm_ctx_batch_size(ctx);
+    int8_t* in = tflm_ctx_input(ctx, NULL);
+    const int8_t* out = tflm_ctx_output(ctx, NULL);
+    uint8_t labels[8];  // CNN_BATCH <= 8
+    if (batch < 1 || batch > 8) return;
+
+    const uint8_t* p = selftest_blob;
+    const uint8_t* end = selftest_blob + sizeof(selftest_blob);
+    uint32_t t0 = time_us_32();
+    for (int done = 0; done < SELFTEST_COUNT;) {
+        // Um batch: as amostras vão direto pros slots do tensor
+        int n = SELFTEST_COUNT - done < batch ? SELFTEST_COUNT - done : batch;
+        for (int k = 0; k < n; k++) {
+            int used = p < end && *p <= 9 ? codec_decode_packed(p + 1, (int)(end - p - 1), in + k * CODEC_PIXELS, lut) : -1;
+            if (used < 0) {
+                res->status = SELFTEST_ERR_DATA;
+                return;
+            }
+            labels[k] = *p;
+            p += 1 + used;
+        }
+        uint32_t t_inv = time_us_32();
+        int rc = tflm_ctx_invoke(ctx);
+        t_inv = time_us_32() - t_inv;
+        if (rc != 0) return;
+        if (t_inv > res->us_max) res->us_max = t_inv;
+        for (int k = 0; k < n; k++) {
+            const int8_t* logits = out + k * SELFTEST_CLASSES;
+            res->crc = proto_crc32(res->crc, (const uint8_t*)logits, SELFTEST_CLASSES);
+            if (argmax_i8(logits, SELFTEST_CLASSES) == labels[k]) res->correct++;
+        }
+        done += n;
+        res->total = (uint32_t)done;
+    }
+    res->us = time_us_32() - t0;
+    if (SELFTEST_LOGITS_CRC == 0) res->status = SELFTEST_NO_REF;
+    else res->status = res->crc == SELFTEST_LOGITS_CRC ? SELFTEST_OK : SELFTEST_FAIL;
+}
+
+void selftest_print(const selftest_result_t* res) {
+    if (res->status < 0) {
+        printf("ERR,SELFTEST,%s,%lu\n", res->status == SELFTEST_ERR_DATA ? "DATA" : "INVOKE", (unsigned long)res->total);
+        return;
+    }
+    static const char* const status[] = {"OK", "FALHA", "SEM_REF"};
+    uint32_t n = res->total ? res->total : 1;
+    printf("SELFTEST,%lu,%lu,%lu,%lu,%lu,%08lx,%s\n", (unsigned long)res->total, (unsigned long)res->correct,
+           (unsigned long)(((uint64_t)res->correct * 1000u + n / 2) / n), (unsigned long)(res->us / n),
+           (unsigned long)res->us_max, (unsigned long)res->crc, status[res->status]);
+}
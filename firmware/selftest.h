@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Autoteste com amostras rotuladas gravadas na flash junto com o firmware
+// (selftest_data.h, gerado no build por test/pack_selftest.py). Cada amostra é
+// decodificada direto no tensor de entrada, já quantizada pela LUT, sem buffer da
+// imagem nem do dataset em RAM; o blob é lido pelo XIP.
+//
+// No blob, um byte de label seguido da imagem na codificação binária do mnist_codec
+// (corridas de zeros e literais, sem perda): ~200 bytes por amostra do MNIST
+//
+// Comando ($SELFTEST) e boot (CNN_SELFTEST_BOOT) respondem uma linha:
+//   SELFTEST,<n>,<acertos>,<acc_x1000>,<us_por_amostra>,<us_max_invoke>,<crc32>,<OK|FALHA|SEM_REF>
+// crc32 é o CRC-32 (zlib) dos logits int8 de todas as amostras em ordem; OK/FALHA
+// compara com o CRC dos logits de referência dado no build, SEM_REF se não teve
+
+#ifndef CNN_SELFTEST
+#define CNN_SELFTEST 1
+#endif
+#ifndef CNN_SELFTEST_BOOT
+#define CNN_SELFTEST_BOOT 1  // roda uma vez no boot, antes de aceitar amostras
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t total;
+    uint32_t correct;
+    uint32_t us;          // decodificação + invoke + argmax de todas as amostras
+    uint32_t us_max;      // invoke mais lento (um batch inteiro com CNN_BATCH > 1)
+    uint32_t crc;         // CRC-32 dos logits
+    int status;           // SELFTEST_OK, SELFTEST_FAIL, SELFTEST_NO_REF, ou < 0 em erro
+} selftest_result_t;
+
+#define SELFTEST_OK 0
+#define SELFTEST_FAIL 1
+#define SELFTEST_NO_REF 2
+#define SELFTEST_ERR_DATA -1    // blob corrompido
+#define SELFTEST_ERR_INVOKE -2  // invoke falhou ou tensor de entrada ocupado
+
+// Roda todas as amostras no contexto padrão do TFLM (tensor de entrada tem que estar livre)
+void selftest_run(selftest_result_t* res);
+void selftest_print(const selftest_result_t* res);
+
+#ifdef __cplusplus
+}
+#endif
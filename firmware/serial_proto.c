@@ -0,0 +1,49 @@
+#include "serial_proto.h"
+#include <stdio.h>
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bit a bit pra não gastar tabela
+uint16_t proto_crc16_update(uint16_t crc, char c) {
+    crc ^= (uint16_t)((uint8_t)c << 8);
+    for (int b = 0; b < 8; b++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+uint16_t proto_crc16(const char* data, int len) {
+    uint16_t crc = PROTO_CRC_INIT;
+    for (int i = 0; i < len; i++) crc = proto_crc16_update(crc, data[i]);
+    return crc;
+}
+
+// Tabela por nibble (16 entradas) em vez dos 1 KB da tabela por byte
+uint32_t proto_crc32(uint32_t crc, const uint8_t* data, uint32_t len) {
+    static const uint32_t nib[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (crc >> 4) ^ nib[(crc ^ data[i]) & 0x0F];
+        crc = (crc >> 4) ^ nib[(crc ^ (data[i] >> 4)) & 0x0F];
+    }
+    return ~crc;
+}
+
+void proto_send_window(int credit) {
+    printf("W,%d,%d\n", PROTO_WINDOW, credit);
+}
+
+void proto_send_result(uint32_t id, int pred, int label, int conf_x10,
+                       int rx_bytes, uint32_t decode_us, int credit) {
+    printf("R,%lu,%d,%d,%d,%d,%lu,%d\n", (unsigned long)id, pred, label, conf_x10,
+           rx_bytes, (unsigned long)decode_us, credit);
+}
+
+void proto_send_nak(const uint32_t* id, const char* reason, int credit) {
+    if (id) {
+        printf("N,%lu,%s,%d\n", (unsigned long)*id, reason, credit);
+    } else {
+        printf("N,?,%s,%d\n", reason, credit);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Protocolo com IDs de requisição e janela de créditos na serial
+//
+// Host -> device:
+//   @<id>,<label>,<p1>,...,<p784>*<crc>   requisição (crc = CRC-16 em hex de "<id>,...,<p784>")
+//   @<id>,R,<label>,<dados>*<crc>         idem, imagem em run-length (ver mnist_codec.h)
+//   @<id>,S,<label>,<dados>*<crc>         idem, imagem em pares índice/valor
+//   @?                                    pergunta a janela atual
+// Device -> host:
+//   W,<window>,<credit>                   anúncio da janela (slots totais e livres)
+//   R,<id>,<pred>,<label>,<conf>,<bytes>,<decode_us>,<credit>
+//                                         resultado (conf em décimos de %, bytes do frame
+//                                         recebido e tempo de decodificação da imagem,
+//                                         somado char a char durante a recepção)
+//   N,<id>,<motivo>,<credit>              NAK individual (id "?" se ilegível)
+// Linhas que começam com dígito continuam no modo CSV antigo (saída verbosa).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CNN_BATCH
+#define CNN_BATCH 1
+#endif
+
+// Slots de entrada que o host pode manter ocupados (cobre um batch inteiro do modelo)
+#define PROTO_WINDOW (CNN_BATCH > 4 ? CNN_BATCH : 4)
+
+#define PROTO_OK       0
+#define PROTO_ERR_FMT -1  // frame sem id/crc legível
+#define PROTO_ERR_CRC -2  // crc não confere
+
+#define PROTO_CRC_INIT 0xFFFF
+
+uint16_t proto_crc16(const char* data, int len);  // CRC-16/CCITT-FALSE
+uint16_t proto_crc16_update(uint16_t crc, char c); // Mesmo CRC, um byte por vez (recepção em streaming)
+// CRC-32 do zlib (o mesmo do zlib.crc32 do Python); crc 0 no começo, ou o resultado
+// anterior pra continuar (upload do modelo em pedaços)
+uint32_t proto_crc32(uint32_t crc, const uint8_t* data, uint32_t len);
+
+void proto_send_window(int credit);
+void proto_send_result(uint32_t id, int pred, int label, int conf_x10,
+                       int rx_bytes, uint32_t decode_us, int credit);
+void proto_send_nak(const uint32_t* id, const char* reason, int credit); // id NULL = ilegível
+
+#ifdef __cplusplus
+}
+#endif
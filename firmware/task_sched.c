@@ -0,0 +1,116 @@
+#include "task_sched.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    sched_task_fn fn;
+    uint32_t period_us;
+    volatile bool pending;  // escrito por interrupção: um byte, sem read-modify-write
+    bool timed;
+    uint32_t wake_us;
+    uint32_t runs;
+    uint64_t total_us;
+    uint32_t max_us;
+} sched_task_t;
+
+static sched_task_t tasks[SCHED_MAX_TASKS];
+static int n_tasks = 0;
+static uint32_t idle_wakes = 0;
+static uint64_t idle_us = 0;
+static uint32_t idle_max_us = 0;
+
+void sched_add(int id, const char* name, sched_task_fn fn, uint32_t period_us) {
+    if (id < 0 || id >= SCHED_MAX_TASKS) return;
+    sched_task_t* t = &tasks[id];
+    t->name = name;
+    t->fn = fn;
+    t->period_us = period_us;
+    t->pending = false;
+    t->timed = period_us > 0;
+    t->wake_us = time_us_32() + period_us;
+    if (id >= n_tasks) n_tasks = id + 1;
+}
+
+void sched_signal(int id) {
+    tasks[id].pending = true;
+}
+
+void sched_wake_at(int id, uint32_t at_us) {
+    tasks[id].timed = true;
+    tasks[id].wake_us = at_us;
+}
+
+static bool due(const sched_task_t* t, uint32_t now) {
+    return t->fn && (t->pending || (t->timed && (int32_t)(now - t->wake_us) >= 0));
+}
+
+static void run_task(sched_task_t* t, uint32_t now) {
+    t->pending = false;  // antes de rodar: um sinal durante a execução não se perde
+    if (t->timed && (int32_t)(now - t->wake_us) >= 0) t->timed = false;
+    bool again = t->fn(now);
+    uint32_t us = time_us_32() - now;
+    if (again) t->pending = true;
+    if (t->period_us && !t->timed) {
+        t->timed = true;
+        t->wake_us = now + t->period_us;
+    }
+    t->runs++;
+    t->total_us += us;
+    if (us > t->max_us) t->max_us = us;
+}
+
+// Dorme até o prazo mais próximo; interrupção (chegada na serial, alarme do USB,
+// SEV do core1) acorda antes. Uma interrupção entre a última checagem e o WFE deixa
+// o registrador de evento ligado, então o WFE volta na hora e o sinal não se perde
+static void idle(uint32_t now) {
+    int32_t wait = INT32_MAX;
+    for (int i = 0; i < n_tasks; i++) {
+        const sched_task_t* t = &tasks[i];
+        if (t->pending) return;
+        if (t->fn && t->timed) {
+            int32_t d = (int32_t)(t->wake_us - now);
+            if (d < wait) wait = d;
+        }
+    }
+    if (wait <= 0) return;
+    best_effort_wfe_or_timeout(make_timeout_time_us((uint64_t)wait));
+    uint32_t slept = time_us_32() - now;
+    idle_wakes++;
+    idle_us += slept;
+    if (slept > idle_max_us) idle_max_us = slept;
+}
+
+void sched_run(void) {
+    for (;;) {
+        uint32_t now = time_us_32();
+        int i = 0;
+        while (i < n_tasks && !due(&tasks[i], now)) i++;
+        if (i < n_tasks) run_task(&tasks[i], now);
+        else idle(now);
+    }
+}
+
+void sched_report(void) {
+    for (int i = 0; i < n_tasks; i++) {
+        const sched_task_t* t = &tasks[i];
+        if (!t->fn) continue;
+        printf("SCHED,%s,%lu,%llu,%lu\n", t->name, (unsigned long)t->runs, (unsigned long long)t->total_us,
+               (unsigned long)t->max_us);
+    }
+    printf("SCHED,idle,%lu,%llu,%lu\n", (unsigned long)idle_wakes, (unsigned long long)idle_us,
+           (unsigned long)idle_max_us);
+    printf("SCHED,END\n");
+}
+
+void sched_reset(void) {
+    for (int i = 0; i < n_tasks; i++) {
+        tasks[i].runs = 0;
+        tasks[i].total_us = 0;
+        tasks[i].max_us = 0;
+    }
+    idle_wakes = 0;
+    idle_us = 0;
+    idle_max_us = 0;
+}
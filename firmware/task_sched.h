@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Escalonador cooperativo do loop principal (core0): tarefas curtas que rodam até
+// o fim, escolhidas por prioridade (ordem do id) entre as prontas. Uma tarefa fica
+// pronta por evento (sched_signal, que pode vir de interrupção ou callback), por
+// tempo (sched_wake_at) ou porque pediu pra continuar (retornou true). Depois de
+// cada execução a escolha recomeça do topo, então uma tarefa de prioridade alta
+// nunca espera mais que uma execução de outra. Sem nada pronto o núcleo dorme (WFE)
+// até o próximo prazo ou até uma interrupção (serial, alarme do USB).
+//
+// Cada tarefa tem execuções, tempo total e pior execução, e o idle tem o tempo
+// dormindo e quantas vezes acordou ($SCHED):
+//   SCHED,<tarefa>,<execuções>,<total_us>,<max_us>   uma linha por tarefa
+//   SCHED,idle,<acordadas>,<total_us>,<max_us>
+//   SCHED,END
+
+#define SCHED_MAX_TASKS 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Retorna true se ainda tem trabalho (continua pronta)
+typedef bool (*sched_task_fn)(uint32_t now_us);
+
+// Registra a tarefa id (0 = mais prioritária); period_us > 0 acorda ela também a
+// cada período, pra quem não tem evento confiável
+void sched_add(int id, const char* name, sched_task_fn fn, uint32_t period_us);
+void sched_signal(int id);                    // pronta agora (seguro em interrupção)
+void sched_wake_at(int id, uint32_t at_us);   // pronta em at_us (substitui o prazo anterior)
+
+void sched_run(void);  // não volta
+
+void sched_report(void);
+void sched_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
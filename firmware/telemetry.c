@@ -0,0 +1,69 @@
+#include "telemetry.h"
+
+#if CNN_TELEMETRY
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t buckets[TELEM_BUCKETS];
+} telem_hist_t;
+
+static telem_hist_t hist[TELEM_STAGE_COUNT];
+static uint32_t counters[TELEM_COUNTER_COUNT];
+
+#define TELEM_STAGE_NAME(id, name) name,
+static const char* const stage_names[TELEM_STAGE_COUNT] = {
+    TELEM_STAGE_LIST(TELEM_STAGE_NAME)
+};
+#undef TELEM_STAGE_NAME
+static const char* const counter_names[TELEM_COUNTER_COUNT] = {
+    "samples", "parse_fail", "crc_fail", "timeout", "overflow", "frames", "coalesced"
+};
+
+// Índice do bucket = posição do bit mais alto (log2 inteiro)
+static int bucket_of(uint32_t us) {
+    int b = 0;
+    while (us > 1 && b < TELEM_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void telem_record(telem_stage_t stage, uint32_t us) {
+    telem_hist_t* h = &hist[stage];
+    if (h->count == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->count++;
+    h->sum_us += us;
+    h->buckets[bucket_of(us)]++;
+}
+
+void telem_count(telem_counter_t counter) {
+    counters[counter]++;
+}
+
+void telem_reset(void) {
+    memset(hist, 0, sizeof(hist));
+    memset(counters, 0, sizeof(counters));
+}
+
+void telem_dump(void) {
+    for (int s = 0; s < TELEM_STAGE_COUNT; s++) {
+        const telem_hist_t* h = &hist[s];
+        printf("S,%s,%lu,%llu,%lu,%lu", stage_names[s], (unsigned long)h->count,
+               (unsigned long long)h->sum_us, (unsigned long)h->min_us, (unsigned long)h->max_us);
+        for (int b = 0; b < TELEM_BUCKETS; b++) printf(",%lu", (unsigned long)h->buckets[b]);
+        printf("\n");
+    }
+    for (int c = 0; c < TELEM_COUNTER_COUNT; c++) {
+        printf("C,%s,%lu\n", counter_names[c], (unsigned long)counters[c]);
+    }
+    printf("S,END\n");
+}
+
+#endif
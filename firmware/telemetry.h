@@ -0,0 +1,89 @@
+#pragma once
+#include <stdint.h>
+#include "trace.h"
+
+// Telemetria por estágio: histogramas de latência (buckets fixos em potências de 2 µs)
+// e contadores de eventos, consultados/zerados pela serial com $STATS
+// Com CNN_TELEMETRY=0 os histogramas somem; as macros de estágio continuam
+// alimentando o trace (trace.h) se CNN_TRACE=1
+
+#ifndef CNN_TELEMETRY
+#define CNN_TELEMETRY 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Estágios instrumentados (o id também é o id do evento no trace)
+//   rx      primeiro byte da linha até o '\n'
+//   parse   fechamento do frame (crc + imagem completa); a decodificação vai junto com o rx
+//   quant   cópia da reserva pro tensor de entrada (a quantização é feita na recepção, via LUT)
+//   invoke  tflm_invoke()
+//   softmax softmax + argmax
+//   draw    montagem da tela no buffer
+//   flush   envio pro SSD1306 via I2C: um pedaço por medida (tela inteira com CNN_DISPLAY_FPS=0)
+#define TELEM_STAGE_LIST(X) \
+    X(RX, "rx")             \
+    X(PARSE, "parse")       \
+    X(QUANT, "quant")       \
+    X(INVOKE, "invoke")     \
+    X(SOFTMAX, "softmax")   \
+    X(DRAW, "draw")         \
+    X(FLUSH, "flush")
+
+#define TELEM_STAGE_ENUM(id, name) TELEM_##id,
+typedef enum {
+    TELEM_STAGE_LIST(TELEM_STAGE_ENUM)
+    TELEM_STAGE_COUNT
+} telem_stage_t;
+#undef TELEM_STAGE_ENUM
+
+typedef enum {
+    TELEM_SAMPLES = 0,
+    TELEM_PARSE_FAIL,
+    TELEM_CRC_FAIL,
+    TELEM_TIMEOUT,
+    TELEM_OVERFLOW,
+    TELEM_FRAMES,     // quadros desenhados no display
+    TELEM_COALESCED,  // resultados substituídos por um mais novo antes de aparecer
+    TELEM_COUNTER_COUNT
+} telem_counter_t;
+
+#define TELEM_BUCKETS 20  // bucket k: [2^k, 2^(k+1)) µs; o último acumula o resto
+
+#if CNN_TELEMETRY
+
+void telem_record(telem_stage_t stage, uint32_t us);
+void telem_count(telem_counter_t counter);
+void telem_reset(void);
+// Imprime:
+//   S,<estágio>,<n>,<soma_us>,<min_us>,<max_us>,<b0>,...,<b19>   (um por estágio)
+//   C,<contador>,<valor>                                         (um por contador)
+//   S,END
+void telem_dump(void);
+
+// Marca o início de um estágio numa variável local e registra no fim
+// TELEM_SPAN registra um estágio que começou em start_us e termina agora
+#define TELEM_BEGIN(stage, var)     uint32_t var = time_us_32(); TRACE_BEGIN_AT((stage), var)
+#define TELEM_END(stage, var)       do { uint32_t t_end_ = time_us_32(); \
+                                         telem_record((stage), t_end_ - (var)); \
+                                         TRACE_END_AT((stage), t_end_); } while (0)
+#define TELEM_SPAN(stage, start_us) do { uint32_t t_end_ = time_us_32(); \
+                                         telem_record((stage), t_end_ - (start_us)); \
+                                         TRACE_BEGIN_AT((stage), (start_us)); \
+                                         TRACE_END_AT((stage), t_end_); } while (0)
+#define TELEM_COUNT(counter)        telem_count(counter)
+
+#else
+
+#define TELEM_BEGIN(stage, var)     TRACE_BEGIN(stage)
+#define TELEM_END(stage, var)       TRACE_END(stage)
+#define TELEM_SPAN(stage, start_us) do { TRACE_BEGIN_AT((stage), (start_us)); TRACE_END(stage); } while (0)
+#define TELEM_COUNT(counter)        do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,229 @@
+#include "tflm_conv.h"
+#include "tflm_wrapper.h"
+#include "conv_kernels.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include <string.h>
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+// Kernel de referência: guardado na primeira chamada do Register_CONV_2D_FAST
+static ConvRegistration ref_reg;
+
+// Tempo por camada e caminho. Uma linha por Prepare (com dois núcleos cada
+// interpretador tem a sua, sem disputa); o relatório junta as linhas do mesmo filtro
+#define CONV_STATS_MAX 16
+struct ConvStats {
+    const int8_t* filter;  // identifica a camada: as instâncias dividem o modelo
+    int16_t in_h, in_w, in_c, out_h, out_w, out_c;
+    bool fast;             // caminho rápido disponível pra essa camada
+    uint32_t n[2];         // [0] rápido, [1] referência
+    uint64_t us[2];
+};
+static ConvStats stats[CONV_STATS_MAX];
+static int n_stats = 0;
+static volatile bool fast_on = true;
+
+// user_data do nó: o OpData da referência (OpDataConv, ou o do CMSIS-NN, que começa
+// com ele) fica à parte e é trocado no nó só durante as chamadas da referência
+struct FastConv {
+    void* ref;
+    int row;   // linha em stats, -1 = tabela cheia
+    bool fast;
+    conv3x3s2_params_t p;
+};
+
+static void* FastInit(TfLiteContext* context, const char* buffer, size_t length) {
+    void* ref = ref_reg.init(context, buffer, length);
+    if (!ref) return nullptr;
+    FastConv* fc = static_cast<FastConv*>(context->AllocatePersistentBuffer(context, sizeof(FastConv)));
+    if (!fc) return nullptr;
+    memset(fc, 0, sizeof(*fc));
+    fc->ref = ref;
+    fc->row = -1;
+    return fc;
+}
+
+static bool eligible(const TfLiteConvParams* params, const TfLiteTensor* input, const TfLiteTensor* filter,
+                     const TfLiteTensor* bias, const TfLiteTensor* output) {
+#ifdef TFLITE_SINGLE_ROUNDING
+    (void)params, (void)input, (void)filter, (void)bias, (void)output;
+    return false;  // conv_kernels.c só tem a requantização com arredondamento duplo
+#else
+    if (input->type != kTfLiteInt8 || filter->type != kTfLiteInt8 || output->type != kTfLiteInt8) return false;
+    if (!bias || bias->type != kTfLiteInt32) return false;
+    if (params->stride_height != 2 || params->stride_width != 2) return false;
+    if (params->dilation_height_factor != 1 || params->dilation_width_factor != 1) return false;
+    const TfLiteIntArray* fd = filter->dims;
+    if (fd->size != 4 || fd->data[1] != 3 || fd->data[2] != 3) return false;
+    // Sem grupos: os canais do filtro têm que ser os da entrada
+    if (input->dims->size != 4 || fd->data[3] != input->dims->data[3]) return false;
+    return fd->data[3] <= CONV3X3S2_MAX_IC && filter->data.int8 != nullptr;
+#endif
+}
+
+static TfLiteStatus FastPrepare(TfLiteContext* context, TfLiteNode* node) {
+    FastConv* fc = static_cast<FastConv*>(node->user_data);
+    node->user_data = fc->ref;
+    TfLiteStatus st = ref_reg.prepare(context, node);
+    node->user_data = fc;
+    if (st != kTfLiteOk) return st;
+
+    tflite::MicroContext* mc = tflite::GetMicroContext(context);
+    TfLiteTensor* input = mc->AllocateTempInputTensor(node, tflite::kConvInputTensor);
+    TfLiteTensor* filter = mc->AllocateTempInputTensor(node, tflite::kConvWeightsTensor);
+    TfLiteTensor* bias = mc->AllocateTempInputTensor(node, tflite::kConvBiasTensor);
+    TfLiteTensor* output = mc->AllocateTempOutputTensor(node, tflite::kConvOutputTensor);
+    if (!input || !filter || !output) return kTfLiteError;
+    const auto* params = static_cast<const TfLiteConvParams*>(node->builtin_data);
+    const auto* ref = static_cast<const tflite::OpDataConv*>(fc->ref);
+
+    fc->fast = eligible(params, input, filter, bias, output);
+    conv3x3s2_params_t& p = fc->p;
+    p.in_h = input->dims->data[1];
+    p.in_w = input->dims->data[2];
+    p.in_c = input->dims->data[3];
+    p.out_h = output->dims->data[1];
+    p.out_w = output->dims->data[2];
+    p.out_c = output->dims->data[3];
+    if (fc->fast) {
+        p.pad_h = ref->padding.height;
+        p.pad_w = ref->padding.width;
+        p.in_zp = ref->input_zero_point;
+        p.out_zp = ref->output_zero_point;
+        p.act_min = ref->output_activation_min;
+        p.act_max = ref->output_activation_max;
+        p.mult = ref->per_channel_output_multiplier;
+        p.shift = ref->per_channel_output_shift;
+        p.filter = filter->data.int8;
+        // O zero point da entrada é constante: vai pro bias uma vez aqui
+        int32_t* folded = static_cast<int32_t*>(context->AllocatePersistentBuffer(context, p.out_c * sizeof(int32_t)));
+        if (folded) {
+            conv3x3s2_fold_bias(p.filter, bias->data.i32, p.out_c, p.in_c, p.in_zp, folded);
+            p.bias_folded = folded;
+        } else {
+            fc->fast = false;
+        }
+        // Camada da imagem (1 canal): o fundo é a maior parte, janela vazia sai pronta
+        p.blank = nullptr;
+        if (fc->fast && p.in_c == 1) {
+            int8_t* blank = static_cast<int8_t*>(context->AllocatePersistentBuffer(context, p.out_c));
+            if (blank) conv3x3s2_blank_outputs(&p, blank);
+            p.blank = blank;
+        }
+    }
+
+    if (n_stats < CONV_STATS_MAX) {
+        ConvStats& s = stats[n_stats];
+        memset(&s, 0, sizeof(s));
+        s.filter = filter->data.int8;
+        s.in_h = (int16_t)p.in_h;
+        s.in_w = (int16_t)p.in_w;
+        s.in_c = (int16_t)p.in_c;
+        s.out_h = (int16_t)p.out_h;
+        s.out_w = (int16_t)p.out_w;
+        s.out_c = (int16_t)p.out_c;
+        s.fast = fc->fast;
+        fc->row = n_stats++;
+    }
+
+    mc->DeallocateTempTfLiteTensor(input);
+    mc->DeallocateTempTfLiteTensor(filter);
+    if (bias) mc->DeallocateTempTfLiteTensor(bias);
+    mc->DeallocateTempTfLiteTensor(output);
+    return kTfLiteOk;
+}
+
+static TfLiteStatus FastInvoke(TfLiteContext* context, TfLiteNode* node) {
+    FastConv* fc = static_cast<FastConv*>(node->user_data);
+    const bool fast = fc->fast && fast_on;
+    uint32_t t0 = time_us_32();
+    TfLiteStatus st = kTfLiteOk;
+    if (fast) {
+        const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(context, node, tflite::kConvInputTensor);
+        const TfLiteEvalTensor* filter = tflite::micro::GetEvalInput(context, node, tflite::kConvWeightsTensor);
+        TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, tflite::kConvOutputTensor);
+        fc->p.filter = tflite::micro::GetTensorData<int8_t>(filter);
+        const int8_t* in = tflite::micro::GetTensorData<int8_t>(input);
+        int8_t* out = tflite::micro::GetTensorData<int8_t>(output);
+        const int in_size = fc->p.in_h * fc->p.in_w * fc->p.in_c;
+        const int out_size = fc->p.out_h * fc->p.out_w * fc->p.out_c;
+        for (int b = 0; b < input->dims->data[0]; b++) conv3x3s2_i8(&fc->p, in + b * in_size, out + b * out_size);
+    } else {
+        node->user_data = fc->ref;
+        st = ref_reg.invoke(context, node);
+        node->user_data = fc;
+    }
+    if (fc->row >= 0) {
+        ConvStats& s = stats[fc->row];
+        s.n[!fast]++;
+        s.us[!fast] += time_us_32() - t0;
+    }
+    return st;
+}
+
+ConvRegistration Register_CONV_2D_FAST() {
+    ref_reg = tflite::Register_CONV_2D();
+    ConvRegistration reg = ref_reg;
+    reg.init = FastInit;
+    reg.prepare = FastPrepare;
+    reg.invoke = FastInvoke;
+    return reg;
+}
+
+void tflm_conv_forget() {
+    n_stats = 0;
+}
+
+void tflm_conv_set_fast(bool on) {
+    fast_on = on;
+}
+
+// CONV,<camada>,<entrada>,<saída>,<FAST|REF>,<n rápido>,<us rápido>,<n ref>,<us ref>,<ganho>
+// "ganho" é o tempo médio da referência sobre o do rápido (0.00 se faltar um dos dois)
+static void conv_report(void) {
+    printf("CONV,MODE,%s\n", fast_on ? "FAST" : "REF");
+    int layer = 0;
+    for (int i = 0; i < n_stats; i++) {
+        bool seen = false;
+        for (int j = 0; j < i && !seen; j++) seen = stats[j].filter == stats[i].filter;
+        if (seen) continue;
+        uint32_t n[2] = {0, 0};
+        uint64_t us[2] = {0, 0};
+        for (int j = i; j < n_stats; j++) {
+            if (stats[j].filter != stats[i].filter) continue;
+            for (int k = 0; k < 2; k++) {
+                n[k] += stats[j].n[k];
+                us[k] += stats[j].us[k];
+            }
+        }
+        uint64_t gain = 0;  // centésimos
+        if (n[0] && n[1] && us[0]) gain = us[1] * n[0] * 100 / (us[0] * n[1]);
+        const ConvStats& s = stats[i];
+        printf("CONV,%d,%dx%dx%d,%dx%dx%d,%s,%lu,%llu,%lu,%llu,%lu.%02lu\n", layer++, s.in_h, s.in_w, s.in_c,
+               s.out_h, s.out_w, s.out_c, s.fast ? "FAST" : "REF", (unsigned long)n[0], (unsigned long long)us[0],
+               (unsigned long)n[1], (unsigned long long)us[1], (unsigned long)(gain / 100), (unsigned long)(gain % 100));
+    }
+    printf("CONV,END\n");
+}
+
+extern "C" void tflm_conv_command(const char* arg) {
+    while (*arg == ' ') arg++;
+    if (*arg == '\0') {
+        conv_report();
+        return;
+    }
+    if (strcmp(arg, "FAST") == 0 || strcmp(arg, "REF") == 0) {
+        fast_on = arg[0] == 'F';
+    } else if (strcmp(arg, "RESET") == 0) {
+        for (int i = 0; i < n_stats; i++) {
+            memset(stats[i].n, 0, sizeof(stats[i].n));
+            memset(stats[i].us, 0, sizeof(stats[i].us));
+        }
+    } else {
+        printf("ERR,CONV\n");
+        return;
+    }
+    printf("OK,CONV,%s\n", arg);
+}
@@ -0,0 +1,18 @@
+#pragma once
+// CONV_2D do resolver: as camadas int8 3x3 stride 2 (ic <= CONV3X3S2_MAX_IC) vão pro
+// kernel de conv_kernels.c, o resto cai no kernel de referência do TFLM. O Prepare
+// é sempre o da referência (multiplicadores por canal, padding, faixa da ativação);
+// a decisão é tomada uma vez por camada, no fim do Prepare.
+// Cada invoke de conv é cronometrado por camada e caminho ($CONV, ver tflm_wrapper.h)
+#include "tensorflow/lite/micro/kernels/conv.h"
+
+// Mesmo tipo do Register_CONV_2D() da versão do TFLM em uso (TfLiteRegistration ou TFLMRegistration)
+using ConvRegistration = decltype(tflite::Register_CONV_2D());
+
+ConvRegistration Register_CONV_2D_FAST();
+
+// Esquece as camadas registradas (o interpretador vai ser desfeito e remontado)
+void tflm_conv_forget();
+
+// false = todas as camadas pela referência (medir a diferença / conferir)
+void tflm_conv_set_fast(bool on);
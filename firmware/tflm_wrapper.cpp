@@ -1,95 +1,407 @@
 #include "tflm_wrapper.h"
-#include "mnist_cnn_int8_model_v1.h"
+#include "mem_pool.h"
+#include "model_store.h"
+#include "tflm_conv.h"
+#include "trace.h"
+// Modelo embarcado: o padrão tem batch 1; com CNN_BATCH > 1 o CMake aponta pro
+// header exportado pelo notebook com a dimensão de batch fixa
+#ifndef CNN_MODEL_HEADER
+#define CNN_MODEL_HEADER "mnist_cnn_int8_model_v1.h"
+#endif
+#include CNN_MODEL_HEADER
+#include "pico/time.h"
+#include <new>
+#include <stdio.h>
+#include <string.h>
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
-// Arena de 120KB pra tensores intermediários da CNN
-static constexpr int kTensorArenaSize = 120 * 1024;
-alignas(16) static uint8_t tensor_arena[kTensorArenaSize];  // alinhado em 16 bytes pra performance
+// Arena pros tensores intermediários da CNN (bloco alinhado em 16 bytes do mem_pool)
+static constexpr int kTensorArenaSize = TFLM_ARENA_SIZE;
 
-static const tflite::Model* model_ptr = nullptr;
-static tflite::MicroInterpreter* interpreter_ptr = nullptr;
-static TfLiteTensor* input_ptr = nullptr;   // tensor de entrada [1, 28, 28, 1] int8
-static TfLiteTensor* output_ptr = nullptr;  // tensor de saída [1, 10] int8
+// Dono do tensor de entrada: livre, sendo preenchido pela serial, ou em invoke
+enum InputState : uint8_t { INPUT_IDLE, INPUT_FILLING, INPUT_BUSY };
 
-// Inicializa TFLM e carrega modelo da flash
-extern "C" int tflm_init(void) {
-    model_ptr = tflite::GetModel(mnist_cnn_int8_model);  // carrega modelo embarcado
-    if (!model_ptr) return 1;
-    if (model_ptr->version() != TFLITE_SCHEMA_VERSION) return 2;  // verifica compatibilidade
-    
-    // Registra apenas as operações usadas pelo modelo (economiza memória)
-    static tflite::MicroMutableOpResolver<8> resolver;
-    resolver.AddConv2D();           // camadas convolucionais
+#if CNN_TRACE
+// Profiler que manda cada op do TFLM pro trace (arg = índice da op dentro do invoke)
+class TraceProfiler : public tflite::MicroProfilerInterface {
+public:
+    uint32_t BeginEvent(const char* tag) override {
+        uint8_t id = trace_intern(tag);
+        uint8_t op = op_index_++;
+        trace_record(id, TRACE_PHASE_BEGIN, op, time_us_32());
+        return (uint32_t)id | ((uint32_t)op << 8);  // handle carrega id e índice
+    }
+    void EndEvent(uint32_t handle) override {
+        trace_record((uint8_t)handle, TRACE_PHASE_END, (uint8_t)(handle >> 8), time_us_32());
+    }
+    void StartInvoke() { op_index_ = 0; }
+private:
+    uint8_t op_index_ = 0;
+};
+static TraceProfiler trace_profiler;
+#define TFLM_PROFILER (&trace_profiler)
+#if CNN_DUAL_CORE
+static TraceProfiler trace_profiler1;  // índice de op próprio: as duas instâncias rodam ao mesmo tempo
+#define TFLM_PROFILER1 (&trace_profiler1)
+#endif
+#else
+#define TFLM_PROFILER nullptr
+#define TFLM_PROFILER1 nullptr
+#endif
+
+// Um interpretador com os seus tensores, montado no começo da arena que o chamador
+// passou (o TFLM fica com o resto). Nada aqui é compartilhado entre contextos além
+// do resolver e do modelo, os dois só de leitura depois de montados
+struct tflm_ctx {
+    alignas(tflite::MicroInterpreter) uint8_t interpreter_storage[sizeof(tflite::MicroInterpreter)];
+    tflite::MicroInterpreter* interpreter;
+    TfLiteTensor* input;   // tensor de entrada [N, 28, 28, 1] int8
+    TfLiteTensor* output;  // tensor de saída [N, 10] int8
+    tflite::MicroProfilerInterface* profiler;  // TraceProfiler das instâncias do tflm_init, senão nullptr
+    volatile InputState input_state;
+};
+static constexpr int kCtxHeader = (sizeof(tflm_ctx) + 15) & ~15;  // a arena do TFLM continua alinhada em 16
+static int live_contexts = 0;
+
+// Contextos do tflm_init: as funções sem ctx usam a instância 0; com CNN_DUAL_CORE
+// existe a 1 (core1), com arena própria e o mesmo modelo
+static tflm_ctx* instances[2] = {nullptr, nullptr};
+static const uint8_t* model_data = nullptr;  // flatbuffer em uso (embutido ou slot da flash, via XIP)
+static uint32_t model_size = 0;
+static int model_slot = -1;                  // slot da partição de modelos, -1 = embutido
+
+// Aloca os tensores e confere entrada/saída int8; retorna 0 ou o código do tflm_init
+static int setup_instance(tflite::MicroInterpreter* interp, TfLiteTensor** in, TfLiteTensor** out) {
+    if (interp->AllocateTensors() != kTfLiteOk) return 3;  // aloca memória pros tensores
+    *in  = interp->input(0);   // pega referência do tensor de entrada
+    *out = interp->output(0);  // pega referência do tensor de saída
+    if (!*in || !*out) return 4;
+    // Valida que o modelo é realmente int8
+    if ((*in)->type != kTfLiteInt8)  return 5;
+    if ((*out)->type != kTfLiteInt8) return 6;
+    return 0;
+}
+
+// Registra apenas as operações usadas pelo modelo (economiza memória). Montado no
+// primeiro contexto; criar o primeiro contexto não pode correr em paralelo com outro
+static tflite::MicroMutableOpResolver<9> resolver;
+static bool resolver_ready = false;
+
+static void setup_resolver(void) {
+    if (resolver_ready) return;
+    resolver.AddConv2D(Register_CONV_2D_FAST());  // camadas convolucionais (3x3 stride 2 no kernel próprio)
+    resolver.AddDepthwiseConv2D();  // variantes com conv separável (notebook, seção 16)
     resolver.AddMean();             // GlobalAveragePooling2D é implementado como MEAN
     resolver.AddFullyConnected();   // camada densa
     resolver.AddSoftmax();          // ativação final
     resolver.AddReshape();          // reshape entre camadas
     resolver.AddQuantize();         // operações de quantização
     resolver.AddDequantize();
-    
-    // Cria interpretador estático (evita alocação dinâmica)
-    static tflite::MicroInterpreter static_interpreter(
-        model_ptr, resolver, tensor_arena, kTensorArenaSize
+    resolver_ready = true;
+}
+
+// Confere um flatbuffer vindo de fora (upload pela serial): estrutura e versão do schema
+extern "C" int tflm_model_check(const uint8_t* data, uint32_t size) {
+    flatbuffers::Verifier verifier(data, size);
+    if (!tflite::VerifyModelBuffer(verifier)) return 1;
+    if (tflite::GetModel(data)->version() != TFLITE_SCHEMA_VERSION) return 2;
+    return 0;
+}
+
+// Monta um contexto no começo da arena; se falhar, desfaz e devolve o código do tflm_init
+static tflm_ctx* ctx_create(const uint8_t* data, uint32_t size, bool verify, uint8_t* arena, int arena_size,
+                            tflite::MicroProfilerInterface* profiler, int* rc) {
+    *rc = verify ? tflm_model_check(data, size) : 0;
+    if (*rc != 0) return nullptr;
+    const tflite::Model* model = tflite::GetModel(data);
+    if (!model) {
+        *rc = 1;
+        return nullptr;
+    }
+    if (model->version() != TFLITE_SCHEMA_VERSION) {  // verifica compatibilidade
+        *rc = 2;
+        return nullptr;
+    }
+    // O contexto vai no começo da arena, alinhado em 16 (o mem_pool já entrega assim)
+    uintptr_t skip = (16 - (reinterpret_cast<uintptr_t>(arena) & 15)) & 15;
+    if (!arena || arena_size < (int)skip + kCtxHeader + 1024) {
+        *rc = 7;
+        return nullptr;
+    }
+    arena += skip;
+    arena_size -= (int)skip;
+    setup_resolver();
+    tflm_ctx* ctx = new (arena) tflm_ctx();
+    ctx->profiler = profiler;
+    ctx->input_state = INPUT_IDLE;
+    ctx->interpreter = new (ctx->interpreter_storage) tflite::MicroInterpreter(
+        model, resolver, arena + kCtxHeader, arena_size - kCtxHeader,
+        nullptr, profiler  // sem resource variables; ops vão pro trace
     );
-    interpreter_ptr = &static_interpreter;
-    
-    if (interpreter_ptr->AllocateTensors() != kTfLiteOk) return 3;  // aloca memória pros tensores
-    
-    input_ptr  = interpreter_ptr->input(0);   // pega referência do tensor de entrada
-    output_ptr = interpreter_ptr->output(0);  // pega referência do tensor de saída
-    if (!input_ptr || !output_ptr) return 4;
+    *rc = setup_instance(ctx->interpreter, &ctx->input, &ctx->output);
+    if (*rc != 0) {
+        ctx->interpreter->~MicroInterpreter();
+        ctx->~tflm_ctx();
+        if (live_contexts == 0) tflm_conv_forget();  // as linhas do $CONV são só dele
+        return nullptr;
+    }
+    live_contexts++;
+    return ctx;
+}
+
+extern "C" tflm_ctx_t* tflm_ctx_create(const uint8_t* model, uint8_t* arena, int arena_size) {
+    int rc;
+    return ctx_create(model, 0, false, arena, arena_size, nullptr, &rc);
+}
+
+extern "C" void tflm_ctx_destroy(tflm_ctx_t* ctx) {
+    if (!ctx) return;
+    ctx->interpreter->~MicroInterpreter();
+    ctx->~tflm_ctx();
+    live_contexts--;
+}
+
+extern "C" tflm_ctx_t* tflm_ctx_default(void) {
+    return instances[0];
+}
+
+// Instância 0 em cima de um modelo, conferindo o batch do build
+static int try_model(const uint8_t* data, uint32_t size, bool verify, uint8_t* arena) {
+    int rc;
+    tflm_ctx* ctx = ctx_create(data, size, verify, arena, kTensorArenaSize, TFLM_PROFILER, &rc);
+    if (!ctx) return rc;
+    if (tflm_ctx_batch_size(ctx) != CNN_BATCH) {  // modelo não bate com o build
+        tflm_ctx_destroy(ctx);
+        if (live_contexts == 0) tflm_conv_forget();
+        return 8;
+    }
+    instances[0] = ctx;
+    model_data = data;
+    model_size = size;
+    return 0;
+}
+
+// Inicializa TFLM: slot mais novo da partição de modelos, depois o outro, depois o embutido
+extern "C" int tflm_init(void) {
+    uint8_t* tensor_arena = static_cast<uint8_t*>(mem_pool_alloc(MEM_TENSOR_ARENA));
+    if (!tensor_arena) return 7;
     
-    // Valida que o modelo é realmente int8
-    if (input_ptr->type != kTfLiteInt8)  return 5;
-    if (output_ptr->type != kTfLiteInt8) return 6;
+    int rc = -1;
+    for (int rank = 0; rank < MODEL_STORE_SLOTS && rc != 0; rank++) {
+        const uint8_t* data;
+        uint32_t size;
+        model_slot = model_store_get(rank, &data, &size);
+        if (model_slot < 0) break;
+        rc = try_model(data, size, true, tensor_arena);
+        if (rc != 0) printf("Modelo do slot %d rejeitado: %d\n", model_slot, rc);
+    }
+    if (rc != 0) {
+        model_slot = -1;
+        rc = try_model(mnist_cnn_int8_model, sizeof(mnist_cnn_int8_model), false, tensor_arena);
+        if (rc != 0) return rc;
+    }
+
+#if CNN_DUAL_CORE
+    // Segunda instância: mesmo modelo e resolver (só leitura), arena própria
+    uint8_t* arena1 = static_cast<uint8_t*>(mem_pool_alloc(MEM_TENSOR_ARENA1));
+    if (!arena1) return 7;
+    instances[1] = ctx_create(model_data, model_size, false, arena1, kTensorArenaSize, TFLM_PROFILER1, &rc);
+    if (!instances[1]) return rc;
+#if CNN_TRACE
+    // Um invoke de aquecimento em cada instância ainda no core0 registra os nomes das
+    // ops no trace (a tabela de nomes não é protegida contra os dois núcleos ao mesmo tempo)
+    for (tflm_ctx* ctx : instances) {
+        memset(ctx->input->data.int8, 0, ctx->input->bytes);
+        ctx->interpreter->Invoke();
+    }
+#endif
+#endif
     
     return 0;  // sucesso
 }
 
+// ---------------------------------------------------------------------------
+// Por contexto
+
+extern "C" int8_t* tflm_ctx_input(tflm_ctx_t* ctx, int* nbytes) {
+    if (!ctx) return nullptr;
+    if (nbytes) *nbytes = ctx->input->bytes;  // 784 bytes por amostra
+    return ctx->input->data.int8;
+}
+
+extern "C" int8_t* tflm_ctx_output(tflm_ctx_t* ctx, int* nbytes) {
+    if (!ctx) return nullptr;
+    if (nbytes) *nbytes = ctx->output->bytes;  // 10 bytes por amostra
+    return ctx->output->data.int8;
+}
+
+extern "C" float tflm_ctx_input_scale(const tflm_ctx_t* ctx) {
+    return ctx ? ctx->input->params.scale : 0.0f;
+}
+
+extern "C" int tflm_ctx_input_zero_point(const tflm_ctx_t* ctx) {
+    return ctx ? ctx->input->params.zero_point : 0;
+}
+
+extern "C" float tflm_ctx_output_scale(const tflm_ctx_t* ctx) {
+    return ctx ? ctx->output->params.scale : 0.0f;
+}
+
+extern "C" int tflm_ctx_output_zero_point(const tflm_ctx_t* ctx) {
+    return ctx ? ctx->output->params.zero_point : 0;
+}
+
+static int run_invoke(tflm_ctx* ctx) {
+#if CNN_TRACE
+    if (ctx->profiler) static_cast<TraceProfiler*>(ctx->profiler)->StartInvoke();
+#endif
+    return (ctx->interpreter->Invoke() == kTfLiteOk) ? 0 : 2;
+}
+
+extern "C" int tflm_ctx_invoke(tflm_ctx_t* ctx) {
+    if (!ctx) return 1;
+    if (ctx->input_state != INPUT_IDLE) return 3;  // tensor sendo preenchido ou já em invoke
+    ctx->input_state = INPUT_BUSY;
+    int rc = run_invoke(ctx);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+// Dimensão de batch do tensor de entrada [N, 28, 28, 1]
+extern "C" int tflm_ctx_batch_size(const tflm_ctx_t* ctx) {
+    if (!ctx || ctx->input->dims->size < 1) return 0;
+    return ctx->input->dims->data[0];
+}
+
+// Bytes usados da arena, contando o próprio contexto
+extern "C" int tflm_ctx_arena_used_bytes(const tflm_ctx_t* ctx) {
+    if (!ctx) return -1;
+    return (int)ctx->interpreter->arena_used_bytes() + kCtxHeader;
+}
+
+// ---------------------------------------------------------------------------
+// Contexto padrão (instância 0 do tflm_init)
+
 // Retorna ponteiro pro buffer de entrada int8[784]
 extern "C" int8_t* tflm_input_ptr(int* nbytes) {
-    if (!input_ptr) return nullptr;
-    if (nbytes) *nbytes = input_ptr->bytes;  // 784 bytes
-    return input_ptr->data.int8;
+    return tflm_ctx_input(instances[0], nbytes);
 }
 
 // Retorna ponteiro pro buffer de saída int8[10]
 extern "C" int8_t* tflm_output_ptr(int* nbytes) {
-    if (!output_ptr) return nullptr;
-    if (nbytes) *nbytes = output_ptr->bytes;  // 10 bytes
-    return output_ptr->data.int8;
+    return tflm_ctx_output(instances[0], nbytes);
 }
 
 // Retorna scale do tensor de entrada (usado na quantização)
 extern "C" float tflm_input_scale(void) {
-    return input_ptr ? input_ptr->params.scale : 0.0f;
+    return tflm_ctx_input_scale(instances[0]);
 }
 
 // Retorna zero_point do tensor de entrada (usado na quantização)
 extern "C" int tflm_input_zero_point(void) {
-    return input_ptr ? input_ptr->params.zero_point : 0;
+    return tflm_ctx_input_zero_point(instances[0]);
 }
 
 // Retorna scale do tensor de saída (usado na dequantização)
 extern "C" float tflm_output_scale(void) {
-    return output_ptr ? output_ptr->params.scale : 0.0f;
+    return tflm_ctx_output_scale(instances[0]);
 }
 
 // Retorna zero_point do tensor de saída (usado na dequantização)
 extern "C" int tflm_output_zero_point(void) {
-    return output_ptr ? output_ptr->params.zero_point : 0;
+    return tflm_ctx_output_zero_point(instances[0]);
 }
 
-// Executa inferência: processa input_ptr e gera resultado em output_ptr
+// Executa inferência: processa o tensor de entrada e gera resultado no de saída
 extern "C" int tflm_invoke(void) {
-    if (!interpreter_ptr) return 1;
-    return (interpreter_ptr->Invoke() == kTfLiteOk) ? 0 : 2;
+    return tflm_ctx_invoke(instances[0]);
+}
+
+// Entrega o tensor de entrada pra ser preenchido direto pela recepção
+extern "C" int8_t* tflm_input_acquire(void) {
+    tflm_ctx* ctx = instances[0];
+    if (!ctx || ctx->input_state != INPUT_IDLE) return nullptr;
+    ctx->input_state = INPUT_FILLING;
+    return ctx->input->data.int8;
+}
+
+extern "C" void tflm_input_release(void) {
+    tflm_ctx* ctx = instances[0];
+    if (ctx && ctx->input_state == INPUT_FILLING) ctx->input_state = INPUT_IDLE;
+}
+
+// Fecha o preenchimento e roda; o tensor volta a ficar livre quando o invoke termina
+extern "C" int tflm_input_commit_invoke(void) {
+    tflm_ctx* ctx = instances[0];
+    if (!ctx) return 1;
+    if (ctx->input_state != INPUT_FILLING) return 3;
+    ctx->input_state = INPUT_BUSY;
+    int rc = run_invoke(ctx);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+extern "C" int tflm_batch_size(void) {
+    return tflm_ctx_batch_size(instances[0]);
+}
+
+// Um invoke pra até N amostras: o overhead de dispatch e preparo dos kernels é pago uma vez
+extern "C" int tflm_invoke_batch(const int8_t* const* inputs, int8_t* const* outputs, int n) {
+    tflm_ctx* ctx = instances[0];
+    if (!ctx) return 1;
+    int batch = tflm_ctx_batch_size(ctx);
+    if (n < 1 || n > batch) return 4;
+    int8_t* in = ctx->input->data.int8;
+    // FILLING só vale se for a amostra recebida direto no slot 0 (inputs[0] aponta pra ele)
+    if (ctx->input_state == INPUT_BUSY) return 3;
+    if (ctx->input_state == INPUT_FILLING && inputs[0] != in) return 3;
+    ctx->input_state = INPUT_BUSY;
+    const int in_slot = (int)ctx->input->bytes / batch;    // 784 bytes
+    const int out_slot = (int)ctx->output->bytes / batch;  // 10 bytes
+    for (int k = 0; k < n; k++) {
+        if (inputs[k] != in + k * in_slot) memcpy(in + k * in_slot, inputs[k], in_slot);
+    }
+    // Slots além de n ficam com o conteúdo anterior; a saída deles é ignorada
+    int rc = run_invoke(ctx);
+    if (rc == 0) {
+        for (int k = 0; k < n; k++) memcpy(outputs[k], ctx->output->data.int8 + k * out_slot, out_slot);
+    }
+    ctx->input_state = INPUT_IDLE;
+    return rc;
 }
 
 // Retorna quantos bytes da arena estão sendo usados (útil pra debug)
 extern "C" int tflm_arena_used_bytes(void) {
-    if (!interpreter_ptr) return -1;
-    return (int)interpreter_ptr->arena_used_bytes();
+    return tflm_ctx_arena_used_bytes(instances[0]);
+}
+
+extern "C" int tflm_invoke_instance(int inst, const int8_t* input, int8_t* logits) {
+    if (inst < 0 || inst > 1 || !instances[inst]) return 1;
+    tflm_ctx* ctx = instances[inst];
+    // O tensor da 0 também é da recepção: vale o que foi escrito nele (FILLING)
+    // ou uma cópia de fora com ele livre
+    bool in_place = (input == ctx->input->data.int8);
+    if (ctx->input_state != (in_place ? INPUT_FILLING : INPUT_IDLE)) return 3;
+    ctx->input_state = INPUT_BUSY;
+    if (!in_place) memcpy(ctx->input->data.int8, input, ctx->input->bytes);
+    int rc = run_invoke(ctx);
+    if (rc == 0) memcpy(logits, ctx->output->data.int8, ctx->output->bytes);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+extern "C" const uint8_t* tflm_model_data(uint32_t* size) {
+    if (size) *size = model_size;
+    return model_data;
+}
+
+extern "C" int tflm_model_slot(void) {
+    return model_slot;
+}
+
+extern "C" int tflm_instance_arena_used_bytes(int inst) {
+    return inst >= 0 && inst <= 1 ? tflm_ctx_arena_used_bytes(instances[inst]) : -1;
 }
@@ -5,7 +5,48 @@
 extern "C" {
 #endif
 
-int tflm_init(void);  // Inicializa TFLM e carrega modelo, retorna 0 se OK
+#ifndef CNN_DUAL_CORE
+#define CNN_DUAL_CORE 0  // segundo interpretador rodando no core1 (opção CNN_DUAL_CORE do CMake)
+#endif
+
+// Arena de cada interpretador (vem do mem_pool); com dois, cada um fica com a sua
+#ifndef CNN_ARENA_KB
+#define CNN_ARENA_KB (CNN_DUAL_CORE ? 48 : 120)
+#endif
+#define TFLM_ARENA_SIZE (CNN_ARENA_KB * 1024)
+
+#ifndef CNN_BATCH
+#define CNN_BATCH 1  // dimensão de batch fixa do modelo embarcado (opção CNN_BATCH do CMake)
+#endif
+#if CNN_DUAL_CORE && CNN_BATCH > 1
+#error "CNN_DUAL_CORE só com CNN_BATCH=1"
+#endif
+
+// Contexto: um interpretador com arena e tensores próprios. As funções tflm_ctx_* só
+// mexem no contexto que recebem, então contextos diferentes podem rodar ao mesmo tempo
+// (um por thread no host, um por núcleo no device); o mesmo contexto, um uso por vez.
+// As funções sem ctx mais abaixo são o contexto padrão, montado pelo tflm_init
+typedef struct tflm_ctx tflm_ctx_t;
+
+// Monta um contexto sobre model (flatbuffer que precisa continuar válido, já conferido
+// com tflm_model_check se veio de fora) no começo de arena; o TFLM fica com o resto.
+// NULL se não couber ou o modelo não servir. Criar o primeiro contexto registra as ops
+// e não pode correr em paralelo com outra criação
+tflm_ctx_t* tflm_ctx_create(const uint8_t* model, uint8_t* arena, int arena_size);
+void tflm_ctx_destroy(tflm_ctx_t* ctx);  // a arena volta pro chamador
+tflm_ctx_t* tflm_ctx_default(void);      // instância 0 do tflm_init (NULL antes dele)
+
+int8_t* tflm_ctx_input(tflm_ctx_t* ctx, int* nbytes);   // int8[batch*784]
+int8_t* tflm_ctx_output(tflm_ctx_t* ctx, int* nbytes);  // int8[batch*10]
+float tflm_ctx_input_scale(const tflm_ctx_t* ctx);
+int tflm_ctx_input_zero_point(const tflm_ctx_t* ctx);
+float tflm_ctx_output_scale(const tflm_ctx_t* ctx);
+int tflm_ctx_output_zero_point(const tflm_ctx_t* ctx);
+int tflm_ctx_invoke(tflm_ctx_t* ctx);  // 0 se OK, 3 se o tensor de entrada está em uso
+int tflm_ctx_batch_size(const tflm_ctx_t* ctx);
+int tflm_ctx_arena_used_bytes(const tflm_ctx_t* ctx);
+
+int tflm_init(void);  // Inicializa TFLM e carrega modelo, retorna 0 se OK (7 = arena não coube no pool, 8 = batch do modelo != CNN_BATCH)
 
 int8_t* tflm_input_ptr(int* nbytes); // Ponteiro pro buffer de entrada int8[784]
 int8_t* tflm_output_ptr(int* nbytes);  // Ponteiro pro buffer de saída int8[10]
@@ -16,8 +57,39 @@ float tflm_output_scale(void);// Scale do tensor de saída
 int tflm_output_zero_point(void); // Zero point do tensor de saída
 
 int tflm_invoke(void); // Executa inferência, retorna 0 se OK
+
+// Recepção direta no tensor de entrada (sem buffer intermediário)
+// acquire devolve o int8[784] do tensor só se ele não estiver em uso (senão NULL);
+// quem recebe escreve os bytes já quantizados e chama commit_invoke ou release
+int8_t* tflm_input_acquire(void);
+void tflm_input_release(void);   // descarta o que foi escrito (frame inválido)
+int tflm_input_commit_invoke(void); // Fecha a escrita e executa, retorna 0 se OK
 int tflm_arena_used_bytes(void);  // Retorna bytes usados da arena (debug)
 
+// Batch: o modelo tem dimensão de batch fixa (1 no modelo padrão)
+int tflm_batch_size(void);
+// Roda n <= tflm_batch_size() amostras num invoke só: inputs[k] (int8[784]) vai pro slot k
+// do tensor (sem cópia se já apontar pra ele) e os 10 logits do slot k são copiados pra outputs[k]
+int tflm_invoke_batch(const int8_t* const* inputs, int8_t* const* outputs, int n);
+
+// Modelo em uso: o flatbuffer (ponteiro XIP se veio da partição de modelos) e o
+// slot de onde veio, -1 = embutido no firmware (ver model_store.h)
+const uint8_t* tflm_model_data(uint32_t* size);
+int tflm_model_slot(void);
+// Confere estrutura e versão de um .tflite antes de aceitar o upload (0 = OK)
+int tflm_model_check(const uint8_t* data, uint32_t size);
+
+// Instâncias: todas as funções sem ctx usam a 0 (tflm_ctx_default); com CNN_DUAL_CORE
+// existe a 1, outro contexto com arena própria e o mesmo modelo (const, na flash).
+// Cada instância só pode ser usada por um núcleo por vez
+// Copia input (int8[784]) pro tensor da instância, roda e copia os 10 logits
+int tflm_invoke_instance(int inst, const int8_t* input, int8_t* logits);
+int tflm_instance_arena_used_bytes(int inst);
+
+// Trata "$CONV [FAST|REF|RESET]" (arg sem o "CONV"): tempo por camada de conv no
+// kernel próprio e na referência do TFLM, e troca de caminho em tempo de execução (tflm_conv.h)
+void tflm_conv_command(const char* arg);
+
 #ifdef __cplusplus
 }
 #endif
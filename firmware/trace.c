@@ -0,0 +1,96 @@
+#include "trace.h"
+
+#if CNN_TRACE
+#include "pico/stdlib.h"
+#include "telemetry.h"
+#include "mem_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+// Um ring por núcleo: cada núcleo só escreve no seu, sem lock
+typedef struct {
+    trace_event_t events[TRACE_EVENTS_PER_CORE];
+    uint32_t written;  // total já gravado (índice = written % TRACE_EVENTS_PER_CORE)
+} trace_ring_t;
+
+_Static_assert(sizeof(trace_ring_t) * 2 <= TRACE_POOL_BYTES, "TRACE_POOL_BYTES desatualizado");
+
+static trace_ring_t* rings = NULL;  // 2 rings, um por núcleo
+static const char* names[TRACE_MAX_NAMES];
+static uint8_t name_count = 0;
+
+#define TELEM_STAGE_NAME(id, name) name,
+static const char* const stage_names[TELEM_STAGE_COUNT] = {
+    TELEM_STAGE_LIST(TELEM_STAGE_NAME)
+};
+#undef TELEM_STAGE_NAME
+
+void trace_init(void) {
+    rings = (trace_ring_t*)mem_pool_alloc(MEM_TRACE_RINGS);
+    if (rings) trace_reset();
+}
+
+void trace_record(uint8_t event, uint8_t phase, uint8_t arg, uint32_t ts_us) {
+    if (!rings) return;
+    uint core = get_core_num();
+    trace_ring_t* r = &rings[core];
+    trace_event_t* e = &r->events[r->written % TRACE_EVENTS_PER_CORE];
+    e->ts_us = ts_us;
+    e->event = event;
+    e->phase = phase;
+    e->core = (uint8_t)core;
+    e->arg = arg;
+    r->written++;
+}
+
+// Os nomes vêm do TFLM (strings estáticas), então compara ponteiro antes de strcmp
+uint8_t trace_intern(const char* name) {
+    for (uint8_t i = 0; i < name_count; i++) {
+        if (names[i] == name || strcmp(names[i], name) == 0) return (uint8_t)(TRACE_OP_BASE + i);
+    }
+    if (name_count == TRACE_MAX_NAMES) return (uint8_t)(TRACE_OP_BASE + TRACE_MAX_NAMES);  // "outros"
+    names[name_count] = name;
+    return (uint8_t)(TRACE_OP_BASE + name_count++);
+}
+
+void trace_reset(void) {
+    if (!rings) return;
+    rings[0].written = 0;
+    rings[1].written = 0;
+}
+
+void trace_dump(void) {
+    // Copia os contadores antes, pra não misturar eventos gravados durante o dump
+    uint32_t written[2] = { 0, 0 };
+    if (rings) {
+        written[0] = rings[0].written;
+        written[1] = rings[1].written;
+    }
+    uint32_t count = 0, dropped = 0;
+    for (int c = 0; c < 2; c++) {
+        uint32_t n = written[c] < TRACE_EVENTS_PER_CORE ? written[c] : TRACE_EVENTS_PER_CORE;
+        count += n;
+        dropped += written[c] - n;
+    }
+    printf("T,%lu,%u,%lu\n", (unsigned long)count, (unsigned)(TELEM_STAGE_COUNT + name_count),
+           (unsigned long)dropped);
+    for (int i = 0; i < TELEM_STAGE_COUNT; i++) printf("G,%d,%s\n", i, stage_names[i]);
+    for (int i = 0; i < name_count; i++) printf("G,%d,%s\n", TRACE_OP_BASE + i, names[i]);
+    stdio_flush();
+    // Bloco binário sem tradução de fim de linha
+    for (int c = 0; c < 2; c++) {
+        uint32_t n = written[c] < TRACE_EVENTS_PER_CORE ? written[c] : TRACE_EVENTS_PER_CORE;
+        uint32_t first = written[c] - n;
+        for (uint32_t k = 0; k < n; k++) {
+            const trace_event_t* e = &rings[c].events[(first + k) % TRACE_EVENTS_PER_CORE];
+            uint8_t rec[8] = {
+                (uint8_t)e->ts_us, (uint8_t)(e->ts_us >> 8), (uint8_t)(e->ts_us >> 16), (uint8_t)(e->ts_us >> 24),
+                e->event, e->phase, e->core, e->arg
+            };
+            for (int b = 0; b < 8; b++) putchar_raw(rec[b]);
+        }
+    }
+    printf("T,END\n");
+}
+
+#endif
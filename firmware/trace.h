@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+// Trace de eventos em ring buffer na RAM: begin/end com timestamp (µs) e núcleo,
+// pros estágios do firmware (ids = telem_stage_t) e pras ops do TFLM (ids >= TRACE_OP_BASE)
+// Gravar um evento custa uma leitura do timer e 8 bytes no ring, então fica ligado
+// em produção; CNN_TRACE=0 remove tudo. O ring guarda sempre os eventos mais recentes.
+
+#ifndef CNN_TRACE
+#define CNN_TRACE 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_EVENTS_PER_CORE 256  // 2 KB por núcleo
+#define TRACE_OP_BASE         32   // ids dinâmicos (ops do TFLM) começam aqui
+#define TRACE_MAX_NAMES       16
+
+#if CNN_TRACE
+#define TRACE_POOL_BYTES ((TRACE_EVENTS_PER_CORE * 8 + 4) * 2)  // rings dos 2 núcleos (mem_pool)
+#else
+#define TRACE_POOL_BYTES 0
+#endif
+
+#define TRACE_PHASE_BEGIN 'B'
+#define TRACE_PHASE_END   'E'
+
+// Registro binário (little-endian, 8 bytes) como sai no dump
+typedef struct {
+    uint32_t ts_us;
+    uint8_t event;
+    uint8_t phase;  // 'B' ou 'E'
+    uint8_t core;
+    uint8_t arg;    // ex.: índice da op dentro do invoke
+} trace_event_t;
+
+#if CNN_TRACE
+
+void trace_init(void);  // pega os rings do mem_pool; antes disso os eventos são ignorados
+void trace_record(uint8_t event, uint8_t phase, uint8_t arg, uint32_t ts_us);
+uint8_t trace_intern(const char* name);  // id dinâmico pra um nome (ops do TFLM)
+void trace_reset(void);
+// Dump pela serial:
+//   T,<eventos>,<nomes>,<perdidos>
+//   G,<id>,<nome>                    (estágios do firmware e ops registradas)
+//   <eventos * 8 bytes binários>     (núcleo 0 do mais antigo ao mais novo, depois núcleo 1)
+//   T,END
+void trace_dump(void);
+
+#define TRACE_BEGIN(ev)          trace_record((uint8_t)(ev), TRACE_PHASE_BEGIN, 0, time_us_32())
+#define TRACE_END(ev)            trace_record((uint8_t)(ev), TRACE_PHASE_END, 0, time_us_32())
+#define TRACE_BEGIN_AT(ev, ts)   trace_record((uint8_t)(ev), TRACE_PHASE_BEGIN, 0, (ts))
+#define TRACE_END_AT(ev, ts)     trace_record((uint8_t)(ev), TRACE_PHASE_END, 0, (ts))
+
+#else
+
+#define trace_init()             do { } while (0)
+#define TRACE_BEGIN(ev)          do { } while (0)
+#define TRACE_END(ev)            do { } while (0)
+#define TRACE_BEGIN_AT(ev, ts)   do { } while (0)
+#define TRACE_END_AT(ev, ts)     do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
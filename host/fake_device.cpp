@@ -0,0 +1,230 @@
+// Dublê do device num pseudo-terminal: fala o mesmo protocolo (W/R/N) que o
+// firmware, com latência de inferência configurável, pra testar o cliente sem hardware
+// A "predição" é o próprio label (ou um erro proposital a cada --wrong-every amostras)
+#include "mnist_codec.h"
+#include "serial_proto.h"
+#include "eval_stats.h"
+#include "serial_link.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+struct Pending {
+    uint32_t id;
+    uint8_t label;
+    int rx_bytes;
+    long decode_us;
+};
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Frame inteiro numa linha (o firmware valida em streaming, byte a byte, no rx)
+
+// Lê o id decimal logo após o '@' (serve pra NAK de frame truncado ou corrompido)
+static int proto_peek_id(const char* line, uint32_t* id) {
+    if (line[0] != '@') return PROTO_ERR_FMT;
+    const char* p = line + 1;
+    uint32_t v = 0;
+    int digits = 0;
+    while (*p >= '0' && *p <= '9' && digits < 10) {
+        v = v * 10 + (uint32_t)(*p++ - '0');
+        digits++;
+    }
+    if (digits == 0 || *p != ',') return PROTO_ERR_FMT;
+    *id = v;
+    return PROTO_OK;
+}
+
+// Valida "@<id>,<payload>*<crc>" e devolve ponteiro pro payload (terminado em '\0')
+// O id é devolvido mesmo quando o crc falha, pra permitir NAK individual
+static int proto_parse_frame(char* line, uint32_t* id, char** payload) {
+    if (proto_peek_id(line, id) != PROTO_OK) return PROTO_ERR_FMT;
+    // Procura o último '*' (separador do crc)
+    char* star = nullptr;
+    for (char* p = line; *p; p++) {
+        if (*p == '*') star = p;
+    }
+    if (!star) return PROTO_ERR_CRC;
+    int crc_rx = 0;
+    int nhex = 0;
+    for (const char* p = star + 1; *p && *p != ' '; p++) {
+        int v = hex_value(*p);
+        if (v < 0 || nhex == 4) return PROTO_ERR_CRC;
+        crc_rx = (crc_rx << 4) | v;
+        nhex++;
+    }
+    if (nhex == 0) return PROTO_ERR_CRC;
+    // crc cobre tudo entre '@' e '*'
+    if (proto_crc16(line + 1, (int)(star - (line + 1))) != (uint16_t)crc_rx) return PROTO_ERR_CRC;
+    *star = '\0';
+    char* p = line + 1;
+    while (*p != ',') p++;  // já validado por proto_peek_id
+    *payload = p + 1;
+    return PROTO_OK;
+}
+
+static bool decode_csv(const char* p, uint8_t* label, uint8_t* pixels) {
+    char* end = nullptr;
+    long v = std::strtol(p, &end, 10);
+    if (end == p) return false;
+    *label = static_cast<uint8_t>(v);
+    for (int i = 0; i < CODEC_PIXELS; i++) {
+        if (*end != ',') return false;
+        p = end + 1;
+        v = std::strtol(p, &end, 10);
+        if (end == p || v < 0 || v > 255) return false;
+        pixels[i] = static_cast<uint8_t>(v);
+    }
+    return *end == '\0';
+}
+
+static bool decode_payload(const char* payload, uint8_t* label, uint8_t* pixels) {
+    char enc = payload[0];
+    if (enc != CODEC_RLE && enc != CODEC_SPARSE) return decode_csv(payload, label, pixels);
+    char* end = nullptr;
+    long v = std::strtol(payload + 2, &end, 10);
+    if (payload[1] != ',' || *end != ',') return false;
+    *label = static_cast<uint8_t>(v);
+    return ((enc == CODEC_RLE) ? codec_decode_rle(end + 1, pixels) : codec_decode_sparse(end + 1, pixels)) == 0;
+}
+
+int main(int argc, char** argv) {
+    long latency_us = 5000;
+    int window = PROTO_WINDOW;
+    int wrong_every = 0;
+    int nak_every = 0;
+    const char* link_path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (a == "--latency-us" && v) { latency_us = std::atol(v); i++; }
+        else if (a == "--window" && v) { window = std::atoi(v); i++; }
+        else if (a == "--wrong-every" && v) { wrong_every = std::atoi(v); i++; }
+        else if (a == "--nak-every" && v) { nak_every = std::atoi(v); i++; }
+        else if (a == "--link" && v) { link_path = v; i++; }
+        else {
+            std::fprintf(stderr,
+                "uso: %s [--latency-us N] [--window N] [--wrong-every N] [--nak-every N] [--link caminho]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::perror("posix_openpt");
+        return 1;
+    }
+    const char* slave_name = ptsname(master);
+    // Mantém o lado escravo aberto em raw: sem eco e sem EIO quando o cliente fecha
+    int slave = open(slave_name, O_RDWR | O_NOCTTY);
+    if (slave < 0 || !serial_make_raw(slave, 0)) {
+        std::perror("pty");
+        return 1;
+    }
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(slave_name, link_path) != 0) {
+            std::perror("symlink");
+            return 1;
+        }
+    }
+    std::fprintf(stderr, "fake_device em %s (janela %d, latencia %ld us)\n", slave_name, window, latency_us);
+
+    // As respostas usam as mesmas funções do firmware, que escrevem em stdout
+    std::fflush(stdout);
+    dup2(master, STDOUT_FILENO);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    std::deque<Pending> queue;
+    std::string line;
+    uint8_t pixels[CODEC_PIXELS];
+    uint32_t received = 0;
+    eval_stats_t eval{};
+    bool eval_mode = false;
+    auto free_slots = [&]() { return window - static_cast<int>(queue.size()); };
+
+    auto process_head = [&]() {
+        Pending p = queue.front();
+        queue.pop_front();
+        std::this_thread::sleep_for(std::chrono::microseconds(latency_us));
+        int pred = p.label;
+        if (wrong_every > 0 && p.id % static_cast<uint32_t>(wrong_every) == 0) pred = (pred + 1) % 10;
+        if (eval_mode) {
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            eval_add(&eval, p.label, pred,
+                     static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count()));
+        }
+        proto_send_result(p.id, pred, p.label, 999, p.rx_bytes, static_cast<uint32_t>(p.decode_us), free_slots());
+    };
+
+    for (;;) {
+        pollfd pfd{master, POLLIN, 0};
+        int rc = poll(&pfd, 1, queue.empty() ? -1 : 0);
+        if (rc == 0) {
+            process_head();  // link ocioso: "roda a inferência" da mais antiga
+            continue;
+        }
+        char buf[4096];
+        ssize_t n = read(master, buf, sizeof(buf));
+        if (n <= 0) continue;
+        for (ssize_t k = 0; k < n; k++) {
+            char c = buf[k];
+            if (c != '\n' && c != '\r') {
+                line += c;
+                continue;
+            }
+            if (line.empty()) continue;
+            if (line[0] == '$') {
+                // Mesmos comandos de avaliação do firmware
+                if (line == "$EVAL ON") eval_mode = true;
+                else if (line == "$EVAL OFF") eval_mode = false;
+                else if (line == "$EVAL RESET") eval_reset(&eval);
+                if (line == "$EVAL DUMP") {
+                    while (!queue.empty()) process_head();
+                    eval_dump(&eval);
+                } else if (line.rfind("$EVAL ", 0) == 0) {
+                    std::printf("OK,EVAL,%s\n", line.c_str() + 6);
+                } else {
+                    std::printf("ERR,CMD\n");
+                }
+            } else if (line == "@?") {
+                proto_send_window(free_slots());
+            } else if (line[0] == '@') {
+                uint32_t id = 0;
+                char* payload = nullptr;
+                auto t0 = std::chrono::steady_clock::now();
+                int prc = proto_parse_frame(&line[0], &id, &payload);
+                received++;
+                if (prc == PROTO_ERR_FMT) {
+                    proto_send_nak(nullptr, "FMT", free_slots());
+                } else if (prc == PROTO_ERR_CRC || (nak_every > 0 && received % static_cast<uint32_t>(nak_every) == 0)) {
+                    proto_send_nak(&id, "CRC", free_slots());
+                } else {
+                    Pending p{id, 0, static_cast<int>(line.size()), 0};
+                    if (!decode_payload(payload, &p.label, pixels)) {
+                        proto_send_nak(&id, "PARSE", free_slots());
+                    } else {
+                        p.decode_us = static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - t0).count());
+                        if (free_slots() == 0) process_head();
+                        queue.push_back(p);
+                    }
+                }
+            }
+            line.clear();
+        }
+    }
+}
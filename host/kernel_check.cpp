@@ -0,0 +1,870 @@
+// Equivalência e regressão de desempenho das etapas de pré/pós-processamento
+//
+// Roda cada implementação disponível de cada etapa (quantização, decodificação
+// da entrada, softmax, argmax, conv 3x3 stride 2 e, compilado com o TFLM do host,
+// o invoke com e sem o kernel de conv próprio; o motor do host, AVX2 e escalar) nas
+// amostras de test/ e em entradas aleatórias/de borda, compara com a referência
+// (exata ou com tolerância) e mede o tempo de cada uma contra um baseline salvo
+//   kernel_check [--samples ARQ] [--ref-logits ARQ] [--model ARQ] [--baseline ARQ] [--threshold F]
+// Saída: 0 ok, 1 divergência, 2 uso, 3 regressão de desempenho
+//
+// Implementação nova (ex.: quantização vetorizada, softmax em ponto fixo) entra
+// como mais uma linha na tabela da etapa; a referência é sempre a primeira
+#include "mnist_dataset.h"
+#include "mnist_codec.h"
+#include "mnist_kernels.h"
+#include "conv_kernels.h"
+#include "tflite_engine.h"
+#if KERNEL_CHECK_TFLM
+#include "tflm_wrapper.h"
+#include "tflm_conv.h"
+#include "pico/time.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string samples = "test/mnist_test_samples.txt";
+    std::string ref_logits;      // logits do TFLite (notebook, seção 13.1)
+    std::string model = "models/mnist_cnn_int8.tflite";  // pro motor do host
+    std::string baseline;        // compara os tempos com este arquivo
+    std::string save_baseline;   // grava os tempos medidos
+    double threshold = 0.15;     // regressão: mais lento que baseline * (1 + threshold)
+    int random = 200;            // imagens/logits aleatórios além das amostras
+    unsigned seed = 1;
+    int reps = 200;              // repetições de cada medida de tempo
+};
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "uso: %s [opções]\n"
+        "  --samples ARQ        amostras label,p1..p784 (padrão: test/mnist_test_samples.txt)\n"
+        "  --ref-logits ARQ     logits int8 de referência do TFLite, uma linha por amostra\n"
+        "  --model ARQ          .tflite do motor do host (padrão: models/mnist_cnn_int8.tflite)\n"
+        "  --random N           entradas aleatórias extras por etapa (padrão: 200)\n"
+        "  --seed N             semente das entradas aleatórias (padrão: 1)\n"
+        "  --reps N             repetições por medida de tempo (padrão: 200)\n"
+        "  --baseline ARQ       compara os tempos com um baseline salvo\n"
+        "  --threshold F        tolerância de regressão, fração (padrão: 0.15)\n"
+        "  --save-baseline ARQ  grava os tempos medidos como baseline\n",
+        argv0);
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&](void) -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--samples" && (v = next())) o.samples = v;
+        else if (a == "--ref-logits" && (v = next())) o.ref_logits = v;
+        else if (a == "--model" && (v = next())) o.model = v;
+        else if (a == "--random" && (v = next())) o.random = std::max(0, std::atoi(v));
+        else if (a == "--seed" && (v = next())) o.seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        else if (a == "--reps" && (v = next())) o.reps = std::max(1, std::atoi(v));
+        else if (a == "--baseline" && (v = next())) o.baseline = v;
+        else if (a == "--threshold" && (v = next())) o.threshold = std::atof(v);
+        else if (a == "--save-baseline" && (v = next())) o.save_baseline = v;
+        else return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Implementações por etapa
+
+using Image = std::array<uint8_t, CODEC_PIXELS>;
+
+struct QuantParams {
+    float scale;
+    int zp;
+};
+
+// Quantização da imagem inteira (pixel 0..255 -> int8)
+struct QuantImpl {
+    const char* name;
+    void (*fn)(const uint8_t* px, const QuantParams& q, int8_t* out);
+};
+
+static void quant_direct(const uint8_t* px, const QuantParams& q, int8_t* out) {
+    for (int i = 0; i < CODEC_PIXELS; i++) out[i] = quantize_f32_to_i8(static_cast<float>(px[i]) / 255.0f, q.scale, q.zp);
+}
+
+static void quant_lut(const uint8_t* px, const QuantParams& q, int8_t* out) {
+    int8_t lut[256];
+    build_input_lut(lut, q.scale, q.zp);
+    for (int i = 0; i < CODEC_PIXELS; i++) out[i] = lut[px[i]];
+}
+
+static const QuantImpl quant_impls[] = {
+    {"quantize_f32_to_i8", quant_direct},
+    {"build_input_lut", quant_lut},
+};
+
+// Entrada codificada como o host manda (o custo de codificar fica fora da medida)
+struct Encoded {
+    std::string csv, rle, sparse;
+    std::vector<uint8_t> packed;  // binário do autoteste
+};
+
+static Encoded encode_all(const Image& img) {
+    static char buf[4096];
+    Encoded e;
+    codec_encode_csv(img.data(), buf, sizeof(buf));
+    e.csv = buf;
+    codec_encode_rle(img.data(), buf, sizeof(buf));
+    e.rle = buf;
+    codec_encode_sparse(img.data(), buf, sizeof(buf));
+    e.sparse = buf;
+    e.packed.resize(static_cast<size_t>(codec_encode_packed(img.data(), nullptr, 0)));
+    codec_encode_packed(img.data(), e.packed.data(), static_cast<int>(e.packed.size()));
+    return e;
+}
+
+// Texto do frame -> int8[784] quantizado
+struct DecodeImpl {
+    const char* name;
+    bool (*fn)(const Encoded& e, const int8_t* lut, int8_t* out);
+};
+
+static bool stream_decode(char enc, const std::string& data, const int8_t* lut, int8_t* out) {
+    codec_stream_t st;
+    codec_stream_begin(&st, enc, out, lut);
+    for (char c : data) codec_stream_put(&st, c);
+    return codec_stream_end(&st) == 0;
+}
+
+static bool decode_stream_csv(const Encoded& e, const int8_t* lut, int8_t* out) { return stream_decode(CODEC_CSV, e.csv, lut, out); }
+static bool decode_stream_rle(const Encoded& e, const int8_t* lut, int8_t* out) { return stream_decode(CODEC_RLE, e.rle, lut, out); }
+static bool decode_stream_sparse(const Encoded& e, const int8_t* lut, int8_t* out) { return stream_decode(CODEC_SPARSE, e.sparse, lut, out); }
+
+static bool decode_rle_lut(const Encoded& e, const int8_t* lut, int8_t* out) {
+    uint8_t px[CODEC_PIXELS];
+    if (codec_decode_rle(e.rle.c_str(), px) != 0) return false;
+    for (int i = 0; i < CODEC_PIXELS; i++) out[i] = lut[px[i]];
+    return true;
+}
+
+static bool decode_sparse_lut(const Encoded& e, const int8_t* lut, int8_t* out) {
+    uint8_t px[CODEC_PIXELS];
+    if (codec_decode_sparse(e.sparse.c_str(), px) != 0) return false;
+    for (int i = 0; i < CODEC_PIXELS; i++) out[i] = lut[px[i]];
+    return true;
+}
+
+static bool decode_packed(const Encoded& e, const int8_t* lut, int8_t* out) {
+    const int n = static_cast<int>(e.packed.size());
+    return codec_decode_packed(e.packed.data(), n, out, lut) == n;
+}
+
+static const DecodeImpl decode_impls[] = {
+    {"stream_csv", decode_stream_csv},
+    {"stream_rle", decode_stream_rle},
+    {"stream_sparse", decode_stream_sparse},
+    {"decode_rle", decode_rle_lut},
+    {"decode_sparse", decode_sparse_lut},
+    {"decode_packed", decode_packed},
+};
+
+struct SoftmaxImpl {
+    const char* name;
+    void (*fn)(const int8_t* logits, float scale, int zp, float* probs, int n);
+};
+
+static const SoftmaxImpl softmax_impls[] = {
+    {"softmax_i8_to_probs", softmax_i8_to_probs},
+};
+
+struct ArgmaxImpl {
+    const char* name;
+    int (*fn)(const int8_t* v, int n);
+};
+
+static const ArgmaxImpl argmax_impls[] = {
+    {"argmax_i8", argmax_i8},
+};
+
+// Conv 3x3 stride 2 int8 com quantização por canal (uma imagem)
+struct ConvLayer {
+    int in_h, in_w, in_c, out_h, out_w, out_c, pad_h, pad_w;
+    int32_t in_zp, out_zp, act_min, act_max;
+    std::vector<int8_t> filter;  // [out_c][3][3][in_c]
+    std::vector<int32_t> bias, mult, shift;
+    std::vector<int32_t> folded;  // bias com o zero point da entrada (o Prepare do firmware)
+    std::vector<int8_t> blank;    // saída de janela toda no zero point (conv3x3s2_blank_outputs)
+};
+
+struct ConvImpl {
+    const char* name;
+    void (*fn)(const ConvLayer& l, const int8_t* in, int8_t* out);
+};
+
+// MultiplyByQuantizedMultiplier do TFLM (arredondamento duplo do gemmlowp)
+static int32_t requant_ref(int32_t x, int32_t mult, int shift) {
+    int left = shift > 0 ? shift : 0;
+    int right = shift > 0 ? 0 : -shift;
+    int32_t a = static_cast<int32_t>(static_cast<uint32_t>(x) << left);
+    int32_t high;
+    if (a == INT32_MIN && mult == INT32_MIN) {
+        high = INT32_MAX;
+    } else {
+        int64_t ab = static_cast<int64_t>(a) * mult;
+        int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+        high = static_cast<int32_t>((ab + nudge) / (int64_t(1) << 31));
+    }
+    int32_t mask = static_cast<int32_t>((int64_t(1) << right) - 1);
+    int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+    return (high >> right) + ((high & mask) > threshold ? 1 : 0);
+}
+
+// reference_integer_ops::ConvPerChannel do TFLM, reduzido a 3x3 stride 2 e batch 1
+static void conv_reference(const ConvLayer& l, const int8_t* in, int8_t* out) {
+    for (int oy = 0; oy < l.out_h; oy++) {
+        for (int ox = 0; ox < l.out_w; ox++) {
+            const int y0 = oy * 2 - l.pad_h, x0 = ox * 2 - l.pad_w;
+            for (int oc = 0; oc < l.out_c; oc++) {
+                int32_t acc = 0;
+                for (int fy = 0; fy < 3; fy++) {
+                    for (int fx = 0; fx < 3; fx++) {
+                        const int iy = y0 + fy, ix = x0 + fx;
+                        if (iy < 0 || iy >= l.in_h || ix < 0 || ix >= l.in_w) continue;  // padding
+                        for (int ic = 0; ic < l.in_c; ic++) {
+                            int32_t x = in[(iy * l.in_w + ix) * l.in_c + ic];
+                            int32_t w = l.filter[((oc * 3 + fy) * 3 + fx) * l.in_c + ic];
+                            acc += w * (x - l.in_zp);
+                        }
+                    }
+                }
+                acc += l.bias[oc];
+                acc = requant_ref(acc, l.mult[oc], l.shift[oc]) + l.out_zp;
+                acc = std::min(l.act_max, std::max(l.act_min, acc));
+                out[(oy * l.out_w + ox) * l.out_c + oc] = static_cast<int8_t>(acc);
+            }
+        }
+    }
+}
+
+static conv3x3s2_params_t conv_params(const ConvLayer& l, bool blank) {
+    return {l.in_h, l.in_w, l.in_c, l.out_h, l.out_w, l.out_c, l.pad_h, l.pad_w,
+            l.in_zp, l.out_zp, l.act_min, l.act_max,
+            l.filter.data(), l.folded.data(), l.mult.data(), l.shift.data(), blank ? l.blank.data() : nullptr};
+}
+
+static void conv_fast(const ConvLayer& l, const int8_t* in, int8_t* out) {
+    const conv3x3s2_params_t p = conv_params(l, false);
+    conv3x3s2_i8(&p, in, out);
+}
+
+// Pulando as janelas de fundo (o que o firmware faz na primeira camada)
+static void conv_fast_blank(const ConvLayer& l, const int8_t* in, int8_t* out) {
+    const conv3x3s2_params_t p = conv_params(l, true);
+    conv3x3s2_i8(&p, in, out);
+}
+
+static const ConvImpl conv_impls[] = {
+    {"reference", conv_reference},
+    {"conv3x3s2_i8", conv_fast},
+    {"conv3x3s2_i8_blank", conv_fast_blank},
+};
+
+// ---------------------------------------------------------------------------
+// Referências em double (independentes do código do firmware)
+
+static int8_t quant_oracle(int px, const QuantParams& q) {
+    double v = px / 255.0 / q.scale + q.zp;
+    v = std::min(127.0, std::max(-128.0, v));
+    return static_cast<int8_t>(v);  // trunca como o firmware
+}
+
+static void softmax_oracle(const int8_t* logits, double scale, int zp, double* probs, int n) {
+    double mx = -1e300;
+    for (int i = 0; i < n; i++) mx = std::max(mx, scale * (logits[i] - zp));
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += (probs[i] = std::exp(scale * (logits[i] - zp) - mx));
+    for (int i = 0; i < n; i++) probs[i] = probs[i] / sum * 100.0;
+}
+
+static int argmax_oracle(const int8_t* v, int n) {
+    return static_cast<int>(std::max_element(v, v + n) - v);  // primeiro máximo
+}
+
+// ---------------------------------------------------------------------------
+// Conjuntos de entrada
+
+struct Logits {
+    std::array<int8_t, 10> v;
+};
+
+static bool load_ref_logits(const std::string& path, std::vector<Logits>& out, std::vector<uint8_t>& labels) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream ss(line);
+        std::string field;
+        std::vector<int> f;
+        while (std::getline(ss, field, ',')) f.push_back(std::atoi(field.c_str()));
+        if (f.size() != 11) return false;
+        Logits l;
+        for (int i = 0; i < 10; i++) l.v[i] = static_cast<int8_t>(f[i + 1]);
+        labels.push_back(static_cast<uint8_t>(f[0]));
+        out.push_back(l);
+    }
+    return true;
+}
+
+static std::vector<Image> build_images(const std::vector<MnistSample>& samples, int random, std::mt19937& rng) {
+    std::vector<Image> imgs;
+    for (const MnistSample& s : samples) imgs.push_back(s.pixels);
+    Image img{};
+    imgs.push_back(img);                        // tudo fundo
+    img.fill(255);
+    imgs.push_back(img);                        // tudo aceso
+    for (int i = 0; i < CODEC_PIXELS; i++) img[i] = static_cast<uint8_t>(i);
+    imgs.push_back(img);                        // rampa, todos os valores
+    img.fill(0);
+    img[0] = 1;
+    img[CODEC_PIXELS - 1] = 255;
+    imgs.push_back(img);                        // só as pontas
+    for (int i = 0; i < CODEC_PIXELS; i++) img[i] = (i % 2) ? 255 : 0;
+    imgs.push_back(img);                        // alternado (pior caso do RLE)
+    std::uniform_int_distribution<int> pix(0, 255), coin(0, 3);
+    for (int k = 0; k < random; k++) {
+        // metade esparsa como dígito real, metade ruído cheio
+        for (int i = 0; i < CODEC_PIXELS; i++) img[i] = (k % 2 == 0 && coin(rng) != 0) ? 0 : static_cast<uint8_t>(pix(rng));
+        imgs.push_back(img);
+    }
+    return imgs;
+}
+
+static std::vector<Logits> build_logits(const std::vector<Logits>& ref, int random, std::mt19937& rng) {
+    std::vector<Logits> out = ref;
+    Logits l;
+    l.v.fill(0);
+    out.push_back(l);                           // empate geral: argmax fica no 0
+    l.v.fill(-128);
+    out.push_back(l);
+    l.v.fill(127);
+    out.push_back(l);
+    l.v.fill(-128);
+    l.v[9] = 127;
+    out.push_back(l);                           // one-hot saturado no fim
+    l.v.fill(-128);
+    l.v[3] = 100;
+    l.v[7] = 100;
+    out.push_back(l);                           // empate no máximo: fica o 3
+    std::uniform_int_distribution<int> q(-128, 127);
+    for (int k = 0; k < random; k++) {
+        for (auto& x : l.v) x = static_cast<int8_t>(q(rng));
+        out.push_back(l);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Medida de tempo: melhor de 5 rodadas de reps repetições, em ns por item
+
+template <typename F>
+static double time_ns(int reps, size_t items, F&& body) {
+    double best = 1e300;
+    for (int round = 0; round < 5; round++) {
+        auto t0 = Clock::now();
+        for (int r = 0; r < reps; r++) body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        best = std::min(best, ns / (static_cast<double>(reps) * static_cast<double>(items)));
+    }
+    return best;
+}
+
+static volatile int sink;  // impede o compilador de descartar o trabalho medido
+
+struct Report {
+    int failures = 0;
+    std::map<std::string, double> timings;  // nome -> ns por item
+
+    void check(bool ok, const char* stage, const char* impl, const char* fmt, ...) __attribute__((format(printf, 5, 6)));
+};
+
+void Report::check(bool ok, const char* stage, const char* impl, const char* fmt, ...) {
+    if (ok) return;
+    if (++failures > 20) return;  // o resto só conta
+    std::printf("FALHA %s/%s: ", stage, impl);
+    va_list ap;
+    va_start(ap, fmt);
+    std::vprintf(fmt, ap);
+    va_end(ap);
+    std::printf("\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static void check_quant(Report& rep, const std::vector<Image>& imgs, size_t n_time, std::mt19937& rng, int reps) {
+    // Parâmetros do modelo exportado + aleatórios (scale pequeno/grande, zp em todo o range)
+    std::vector<QuantParams> params = {{1.0f / 255.0f, -128}, {1.0f / 256.0f, -128}, {0.5f, 0}, {1e-3f, 127}};
+    std::uniform_real_distribution<float> lscale(-7.0f, 0.0f);
+    std::uniform_int_distribution<int> zp(-128, 127);
+    for (int k = 0; k < 20; k++) params.push_back({std::exp(lscale(rng)), zp(rng)});
+
+    int8_t ref[CODEC_PIXELS], got[CODEC_PIXELS];
+    int oracle_off = 0;
+    for (const QuantParams& q : params) {
+        // A referência do firmware contra a conta em double: só pode diferir por
+        // arredondamento de float bem na fronteira entre dois inteiros
+        for (int p = 0; p < 256; p++) {
+            int d = std::abs(quantize_f32_to_i8(p / 255.0f, q.scale, q.zp) - quant_oracle(p, q));
+            rep.check(d <= 1, "quant", "oracle", "p=%d scale=%g zp=%d diferença %d", p, q.scale, q.zp, d);
+            oracle_off += (d == 1);
+        }
+        for (const Image& img : imgs) {
+            quant_impls[0].fn(img.data(), q, ref);
+            for (const QuantImpl& impl : quant_impls) {
+                impl.fn(img.data(), q, got);
+                rep.check(std::memcmp(ref, got, sizeof(ref)) == 0, "quant", impl.name, "scale=%g zp=%d difere da referência",
+                          q.scale, q.zp);
+            }
+        }
+    }
+    std::printf("quant:   %zu implementações, %zu parâmetros x %zu imagens (%d fronteiras de float vs double)\n",
+                std::size(quant_impls), params.size(), imgs.size(), oracle_off);
+
+    const QuantParams model = params[0];
+    for (const QuantImpl& impl : quant_impls) {
+        rep.timings[std::string("quant/") + impl.name] = time_ns(reps, n_time, [&] {
+            for (size_t k = 0; k < n_time; k++) {
+                impl.fn(imgs[k].data(), model, got);
+                sink = got[0];
+            }
+        });
+    }
+}
+
+static void check_decode(Report& rep, const std::vector<Image>& imgs, size_t n_time, int reps) {
+    int8_t lut[256];
+    build_input_lut(lut, 1.0f / 255.0f, -128);
+    std::vector<Encoded> enc;
+    for (const Image& img : imgs) enc.push_back(encode_all(img));
+
+    int8_t ref[CODEC_PIXELS], got[CODEC_PIXELS];
+    for (size_t k = 0; k < imgs.size(); k++) {
+        for (int i = 0; i < CODEC_PIXELS; i++) ref[i] = lut[imgs[k][i]];
+        for (const DecodeImpl& impl : decode_impls) {
+            std::memset(got, 0x5A, sizeof(got));  // lixo: pixel não escrito aparece na comparação
+            bool ok = impl.fn(enc[k], lut, got);
+            rep.check(ok, "decode", impl.name, "imagem %zu rejeitada", k);
+            rep.check(!ok || std::memcmp(ref, got, sizeof(ref)) == 0, "decode", impl.name, "imagem %zu difere", k);
+        }
+        // Sem LUT o decodificador em streaming devolve o pixel cru
+        codec_stream_t st;
+        codec_stream_begin(&st, CODEC_RLE, got, nullptr);
+        for (char c : enc[k].rle) codec_stream_put(&st, c);
+        rep.check(codec_stream_end(&st) == 0 && std::memcmp(got, imgs[k].data(), sizeof(got)) == 0,
+                  "decode", "stream_raw", "imagem %zu difere", k);
+    }
+    std::printf("decode:  %zu implementações x %zu imagens\n", std::size(decode_impls), imgs.size());
+
+    for (const DecodeImpl& impl : decode_impls) {
+        rep.timings[std::string("decode/") + impl.name] = time_ns(reps, n_time, [&] {
+            for (size_t k = 0; k < n_time; k++) {
+                impl.fn(enc[k], lut, got);
+                sink = got[0];
+            }
+        });
+    }
+}
+
+static void check_post(Report& rep, const std::vector<Logits>& logits, const std::vector<Logits>& timed,
+                       std::mt19937& rng, int reps) {
+    std::vector<QuantParams> params = {{1.0f / 256.0f, -128}, {0.1f, 0}, {1.0f, -128}};
+    std::uniform_real_distribution<float> lscale(-7.0f, 0.0f);
+    std::uniform_int_distribution<int> zp(-128, 127);
+    for (int k = 0; k < 10; k++) params.push_back({std::exp(lscale(rng)), zp(rng)});
+
+    const double tol = 1e-3;  // pontos percentuais
+    double worst = 0.0;
+    float probs[10];
+    double oracle[10];
+    for (const QuantParams& q : params) {
+        for (const Logits& l : logits) {
+            softmax_oracle(l.v.data(), q.scale, q.zp, oracle, 10);
+            for (const SoftmaxImpl& impl : softmax_impls) {
+                impl.fn(l.v.data(), q.scale, q.zp, probs, 10);
+                double err = 0.0, sum = 0.0;
+                for (int i = 0; i < 10; i++) {
+                    err = std::max(err, std::fabs(probs[i] - oracle[i]));
+                    sum += probs[i];
+                }
+                worst = std::max(worst, err);
+                rep.check(err <= tol && std::fabs(sum - 100.0) <= tol * 10, "softmax", impl.name,
+                          "scale=%g zp=%d erro %.2e soma %.6f", q.scale, q.zp, err, sum);
+                // softmax é monotônico: a classe de maior probabilidade é o argmax dos logits
+                int top = static_cast<int>(std::max_element(probs, probs + 10) - probs);
+                rep.check(top == argmax_oracle(l.v.data(), 10), "softmax", impl.name, "top %d != argmax %d", top,
+                          argmax_oracle(l.v.data(), 10));
+            }
+        }
+    }
+    for (const Logits& l : logits) {
+        for (const ArgmaxImpl& impl : argmax_impls) {
+            int got = impl.fn(l.v.data(), 10);
+            rep.check(got == argmax_oracle(l.v.data(), 10), "argmax", impl.name, "%d != %d", got, argmax_oracle(l.v.data(), 10));
+        }
+    }
+    std::printf("softmax: %zu implementações, %zu parâmetros x %zu logits (erro máx %.2e pp, tolerância %.0e)\n",
+                std::size(softmax_impls), params.size(), logits.size(), worst, tol);
+    std::printf("argmax:  %zu implementações x %zu logits\n", std::size(argmax_impls), logits.size());
+
+    for (const SoftmaxImpl& impl : softmax_impls) {
+        rep.timings[std::string("softmax/") + impl.name] = time_ns(reps, timed.size(), [&] {
+            for (const Logits& l : timed) {
+                impl.fn(l.v.data(), 1.0f / 256.0f, -128, probs, 10);
+                sink = static_cast<int>(probs[0]);
+            }
+        });
+    }
+    for (const ArgmaxImpl& impl : argmax_impls) {
+        rep.timings[std::string("argmax/") + impl.name] = time_ns(reps, timed.size(), [&] {
+            for (const Logits& l : timed) sink = impl.fn(l.v.data(), 10);
+        });
+    }
+}
+
+// O que o Prepare do firmware calcula uma vez por camada
+static void prepare_conv(ConvLayer& l) {
+    l.folded.resize(static_cast<size_t>(l.out_c));
+    l.blank.resize(static_cast<size_t>(l.out_c));
+    conv3x3s2_fold_bias(l.filter.data(), l.bias.data(), l.out_c, l.in_c, l.in_zp, l.folded.data());
+    const conv3x3s2_params_t p = conv_params(l, false);
+    conv3x3s2_blank_outputs(&p, l.blank.data());
+}
+
+// Camada aleatória: padding SAME (como o modelo) ou VALID, zero points, faixa da
+// ativação e multiplicadores nos limites do que o conversor do TFLite gera
+static ConvLayer random_conv(int in_h, int in_w, int in_c, int out_c, bool same, std::mt19937& rng) {
+    std::uniform_int_distribution<int> i8(-128, 127), w8(-127, 127), zp(-128, 127), coin(0, 3);
+    std::uniform_int_distribution<int32_t> bias(-40000, 40000), mult(1 << 30, INT32_MAX), shift(-14, 1);
+    ConvLayer l;
+    l.in_h = in_h;
+    l.in_w = in_w;
+    l.in_c = in_c;
+    l.out_c = out_c;
+    l.out_h = same ? (in_h + 1) / 2 : (in_h - 3) / 2 + 1;
+    l.out_w = same ? (in_w + 1) / 2 : (in_w - 3) / 2 + 1;
+    l.pad_h = same ? std::max(0, (l.out_h - 1) * 2 + 3 - in_h) / 2 : 0;
+    l.pad_w = same ? std::max(0, (l.out_w - 1) * 2 + 3 - in_w) / 2 : 0;
+    l.in_zp = zp(rng);
+    l.out_zp = zp(rng);
+    l.act_min = coin(rng) ? l.out_zp : -128;  // ReLU fundida ou sem ativação
+    l.act_max = 127;
+    for (int i = 0; i < out_c * 9 * in_c; i++) l.filter.push_back(static_cast<int8_t>(coin(rng) == 0 ? 0 : w8(rng)));
+    for (int oc = 0; oc < out_c; oc++) {
+        l.bias.push_back(bias(rng));
+        l.mult.push_back(mult(rng));
+        l.shift.push_back(shift(rng));
+    }
+    prepare_conv(l);
+    return l;
+}
+
+static void check_conv(Report& rep, const std::vector<Image>& imgs, size_t n_time, std::mt19937& rng, int reps) {
+    std::uniform_int_distribution<int> dim(3, 20), oc(1, 16), i8(-128, 127), coin(0, 1);
+    const int ics[] = {1, 2, 3, 8, 16, CONV3X3S2_MAX_IC};
+    std::vector<int8_t> in, ref, got;
+    int cases = 0;
+    for (int k = 0; k < 300; k++) {
+        int h = dim(rng), w = dim(rng);
+        ConvLayer l = random_conv(h, w, ics[k % std::size(ics)], oc(rng), coin(rng), rng);
+        in.resize(static_cast<size_t>(h * w * l.in_c));
+        ref.resize(static_cast<size_t>(l.out_h * l.out_w * l.out_c));
+        got.resize(ref.size());
+        for (int v = 0; v < 5; v++) {
+            // ruído, entrada toda no zero point (só o bias conta), nos extremos e um
+            // retângulo de ruído no meio do fundo (janelas vazias e cheias misturadas)
+            const int y0 = dim(rng) % h, y1 = y0 + dim(rng) % (h - y0), x0 = dim(rng) % w, x1 = x0 + dim(rng) % (w - x0);
+            for (size_t i = 0; i < in.size(); i++) {
+                const int y = static_cast<int>(i) / (w * l.in_c), x = static_cast<int>(i) / l.in_c % w;
+                const bool blob = y >= y0 && y <= y1 && x >= x0 && x <= x1;
+                in[i] = static_cast<int8_t>(v == 0 ? i8(rng) : v == 1 ? l.in_zp : v == 2 ? -128 : v == 3 ? 127
+                                            : blob ? i8(rng) : l.in_zp);
+            }
+            conv_impls[0].fn(l, in.data(), ref.data());
+            for (const ConvImpl& impl : conv_impls) {
+                impl.fn(l, in.data(), got.data());
+                rep.check(ref == got, "conv", impl.name, "%dx%dx%d -> %dx%dx%d pad %d,%d zp %d/%d difere da referência",
+                          h, w, l.in_c, l.out_h, l.out_w, l.out_c, l.pad_h, l.pad_w, l.in_zp, l.out_zp);
+            }
+            cases++;
+        }
+    }
+
+    // As duas camadas do modelo, com as imagens como entrada da primeira
+    ConvLayer conv1 = random_conv(28, 28, 1, 8, true, rng);
+    ConvLayer conv2 = random_conv(14, 14, 8, 16, true, rng);
+    conv1.in_zp = -128;
+    prepare_conv(conv1);
+    int8_t lut[256];
+    build_input_lut(lut, 1.0f / 255.0f, -128);
+    std::vector<std::vector<int8_t>> in1, in2;
+    size_t windows = 0, blank = 0;
+    for (const Image& img : imgs) {
+        std::vector<int8_t> q(CODEC_PIXELS), a(14 * 14 * 8), b(14 * 14 * 8);
+        for (int i = 0; i < CODEC_PIXELS; i++) q[i] = lut[img[i]];
+        conv_impls[0].fn(conv1, q.data(), a.data());
+        for (const ConvImpl& impl : conv_impls) {
+            impl.fn(conv1, q.data(), b.data());
+            rep.check(a == b, "conv", impl.name, "camada 1 difere da referência");
+        }
+        if (in1.size() < n_time) {
+            // Janelas da primeira camada sem nenhum traço, nas amostras do dataset
+            for (int oy = 0; oy < 14; oy++) {
+                for (int ox = 0; ox < 14; ox++) {
+                    bool any = false;
+                    for (int y = oy * 2; y < std::min(28, oy * 2 + 3); y++)
+                        for (int x = ox * 2; x < std::min(28, ox * 2 + 3); x++) any |= img[y * 28 + x] != 0;
+                    blank += !any;
+                    windows++;
+                }
+            }
+        }
+        in1.push_back(q);
+        in2.push_back(a);
+        cases++;
+    }
+    std::printf("conv:    %zu implementações x %d casos (ic até %d, SAME/VALID, zp e multiplicadores aleatórios)\n",
+                std::size(conv_impls), cases, CONV3X3S2_MAX_IC);
+
+    std::vector<int8_t> out(14 * 14 * 8);
+    for (const ConvImpl& impl : conv_impls) {
+        rep.timings[std::string("conv1/") + impl.name] = time_ns(reps, n_time, [&] {
+            for (size_t k = 0; k < n_time; k++) {
+                impl.fn(conv1, in1[k].data(), out.data());
+                sink = out[0];
+            }
+        });
+        if (impl.fn == conv_fast_blank) continue;
+        rep.timings[std::string("conv2/") + impl.name] = time_ns(reps, n_time, [&] {
+            for (size_t k = 0; k < n_time; k++) {
+                impl.fn(conv2, in2[k].data(), out.data());
+                sink = out[0];
+            }
+        });
+    }
+    auto gain = [&](const char* layer, const char* impl) {
+        return rep.timings[std::string(layer) + "/reference"] / rep.timings[std::string(layer) + "/" + impl];
+    };
+    // O firmware só pula o fundo na camada da imagem (1 canal)
+    std::printf("conv:    conv1 (28x28x1 -> 14x14x8) %.2fx mais rápida que a referência, %.2fx pulando o fundo "
+                "(%.1f%% das janelas nas %zu amostras)\n",
+                gain("conv1", "conv3x3s2_i8"), gain("conv1", "conv3x3s2_i8_blank"),
+                100.0 * static_cast<double>(blank) / static_cast<double>(std::max<size_t>(windows, 1)), n_time);
+    std::printf("conv:    conv2 (14x14x8 -> 7x7x16) %.2fx mais rápida que a referência\n", gain("conv2", "conv3x3s2_i8"));
+}
+
+// Motor do host (mnist_score): AVX2 e escalar idênticos em todas as imagens e, com
+// --ref-logits, iguais aos logits do TFLite
+static void check_engine(Report& rep, const std::string& model, const std::vector<Image>& imgs,
+                         const std::vector<Logits>& ref, size_t n_time, int reps) {
+    TfliteEngine engine;
+    if (!engine.load(model)) {
+        std::printf("engine:  %s: %s, motor não verificado\n", model.c_str(), engine.error().c_str());
+        return;
+    }
+    const bool avx2 = engine.vector();
+    auto ws = engine.make_workspace();
+    int8_t lut[256];
+    build_input_lut(lut, engine.input_scale(), engine.input_zero_point());
+    std::vector<std::vector<int8_t>> in;
+    for (const Image& img : imgs) {
+        std::vector<int8_t> q(CODEC_PIXELS);
+        for (int i = 0; i < CODEC_PIXELS; i++) q[i] = lut[img[i]];
+        in.push_back(q);
+    }
+    std::vector<int8_t> a(engine.output_bytes()), b(a.size());
+    for (size_t k = 0; k < in.size(); k++) {
+        engine.set_vector(false);
+        engine.run(*ws, in[k].data(), a.data());
+        if (k < ref.size()) {
+            rep.check(a.size() == 10 && std::memcmp(a.data(), ref[k].v.data(), 10) == 0, "engine", "scalar",
+                      "amostra %zu difere do TFLite", k);
+        }
+        if (!avx2) continue;
+        engine.set_vector(true);
+        engine.run(*ws, in[k].data(), b.data());
+        rep.check(a == b, "engine", "avx2", "imagem %zu difere do escalar", k);
+    }
+    for (bool vec : {false, true}) {
+        if (vec && !avx2) break;
+        engine.set_vector(vec);
+        rep.timings[vec ? "engine/avx2" : "engine/scalar"] = time_ns(std::max(1, reps / 20), n_time, [&] {
+            for (size_t k = 0; k < n_time; k++) {
+                engine.run(*ws, in[k].data(), a.data());
+                sink = a[0];
+            }
+        });
+    }
+    std::printf("engine:  %zu imagens, %s%s\n", in.size(), avx2 ? "AVX2 contra o escalar" : "só escalar (CPU sem AVX2)",
+                ref.empty() ? "" : ", amostras contra os logits de referência");
+}
+
+#if KERNEL_CHECK_TFLM
+// tflm_conv.cpp cronometra as convs pelo relógio do SDK (o sim_pico.c não entra aqui)
+extern "C" uint64_t time_us_64(void) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// Saída do tflm_wrapper (TFLM compilado pro host) tem que ser idêntica à do TFLite
+static void check_tflm(Report& rep, const std::vector<MnistSample>& samples, const std::vector<Logits>& ref, int reps) {
+    int rc = tflm_init();
+    if (rc != 0) {
+        rep.check(false, "tflm", "tflm_init", "retornou %d", rc);
+        return;
+    }
+    int8_t lut[256];
+    build_input_lut(lut, tflm_input_scale(), tflm_input_zero_point());
+    size_t n = std::min(samples.size(), ref.size());
+    // Com o kernel de conv próprio (padrão) e com todas as convs pela referência do TFLM
+    for (bool fast : {true, false}) {
+        const char* impl = fast ? "invoke" : "invoke_ref_conv";
+        tflm_conv_set_fast(fast);
+        for (size_t k = 0; k < n; k++) {
+            int8_t* in = tflm_input_acquire();
+            for (int i = 0; i < CODEC_PIXELS; i++) in[i] = lut[samples[k].pixels[i]];
+            rc = tflm_input_commit_invoke();
+            const int8_t* out = tflm_output_ptr(nullptr);
+            rep.check(rc == 0 && std::memcmp(out, ref[k].v.data(), 10) == 0, "tflm", impl, "amostra %zu difere do TFLite", k);
+        }
+        rep.timings[std::string("tflm/") + impl] = time_ns(std::max(1, reps / 20), n, [&] {
+            for (size_t k = 0; k < n; k++) {
+                int8_t* in = tflm_input_acquire();
+                for (int i = 0; i < CODEC_PIXELS; i++) in[i] = lut[samples[k].pixels[i]];
+                tflm_input_commit_invoke();
+            }
+        });
+    }
+    tflm_conv_set_fast(true);
+    std::printf("tflm:    %zu amostras contra os logits de referência, conv própria e do TFLM\n", n);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Baseline: uma linha "etapa/implementação ns_por_item"
+
+static bool load_baseline(const std::string& path, std::map<std::string, double>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream ss(line);
+        std::string name;
+        double ns = 0.0;
+        if (ss >> name >> ns) out[name] = ns;
+    }
+    return true;
+}
+
+static bool save_baseline(const std::string& path, const std::map<std::string, double>& timings) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "# kernel_check: ns por item (imagem, frame ou vetor de logits), melhor de 5 rodadas\n";
+    for (const auto& [name, ns] : timings) out << name << ' ' << ns << '\n';
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+    std::vector<MnistSample> samples;
+    if (!load_mnist_csv(opt.samples, samples) || samples.empty()) {
+        std::fprintf(stderr, "não abriu %s\n", opt.samples.c_str());
+        return 2;
+    }
+    std::vector<Logits> ref;
+    std::vector<uint8_t> ref_labels;
+    if (!opt.ref_logits.empty() && !load_ref_logits(opt.ref_logits, ref, ref_labels)) {
+        std::fprintf(stderr, "não leu %s\n", opt.ref_logits.c_str());
+        return 2;
+    }
+    for (size_t k = 0; k < std::min(ref_labels.size(), samples.size()); k++) {
+        if (ref_labels[k] != samples[k].label) {
+            std::fprintf(stderr, "%s não corresponde a %s (linha %zu)\n", opt.ref_logits.c_str(), opt.samples.c_str(), k + 1);
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(opt.seed);
+    std::vector<Image> imgs = build_images(samples, opt.random, rng);
+    std::vector<Logits> logits = build_logits(ref, opt.random, rng);
+    // O tempo é medido sempre na mesma carga (amostras do dataset e 100 logits de
+    // semente fixa), senão --random/--seed mudariam o ns/item e o baseline não valeria
+    std::mt19937 timing_rng(1);
+    std::vector<Logits> timed_logits = build_logits({}, 100, timing_rng);
+
+    Report rep;
+    check_quant(rep, imgs, samples.size(), rng, opt.reps);
+    check_decode(rep, imgs, samples.size(), opt.reps);
+    check_post(rep, logits, timed_logits, rng, opt.reps);
+    check_conv(rep, imgs, samples.size(), rng, opt.reps);
+    check_engine(rep, opt.model, imgs, ref, samples.size(), opt.reps);
+#if KERNEL_CHECK_TFLM
+    if (ref.empty()) std::printf("tflm:    sem --ref-logits, invoke não verificado\n");
+    else check_tflm(rep, samples, ref, opt.reps);
+#endif
+
+    std::map<std::string, double> base;
+    if (!opt.baseline.empty() && !load_baseline(opt.baseline, base)) {
+        std::fprintf(stderr, "não leu %s\n", opt.baseline.c_str());
+        return 2;
+    }
+    int regressions = 0;
+    std::printf("\n%-32s %12s %12s %8s\n", "implementação", "ns/item", "baseline", "razão");
+    for (const auto& [name, ns] : rep.timings) {
+        auto it = base.find(name);
+        if (it == base.end() || it->second <= 0.0) {
+            std::printf("%-32s %12.1f %12s %8s\n", name.c_str(), ns, "-", "-");
+            continue;
+        }
+        double ratio = ns / it->second;
+        bool slow = ratio > 1.0 + opt.threshold;
+        regressions += slow;
+        std::printf("%-32s %12.1f %12.1f %7.2fx%s\n", name.c_str(), ns, it->second, ratio, slow ? "  REGRESSÃO" : "");
+    }
+
+    if (!opt.save_baseline.empty()) {
+        if (!save_baseline(opt.save_baseline, rep.timings)) {
+            std::fprintf(stderr, "não gravou %s\n", opt.save_baseline.c_str());
+            return 2;
+        }
+        std::printf("baseline gravado em %s\n", opt.save_baseline.c_str());
+    }
+
+    if (rep.failures) {
+        std::printf("\n%d divergências\n", rep.failures);
+        return 1;
+    }
+    if (regressions) {
+        std::printf("\n%d regressões acima de %.0f%%\n", regressions, opt.threshold * 100.0);
+        return 3;
+    }
+    std::printf("\nOK\n");
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "mnist_dataset.h"
+
+#include <cstdlib>
+
+static bool parse_line(const std::string& line, MnistSample& s) {
+    const char* p = line.c_str();
+    char* end = nullptr;
+    long v = std::strtol(p, &end, 10);
+    if (end == p || v < 0 || v > 9) return false;
+    s.label = static_cast<uint8_t>(v);
+    for (size_t i = 0; i < s.pixels.size(); i++) {
+        p = end;
+        while (*p == ',' || *p == ' ' || *p == '\t') p++;
+        v = std::strtol(p, &end, 10);
+        if (end == p || v < 0 || v > 255) return false;
+        s.pixels[i] = static_cast<uint8_t>(v);
+    }
+    while (*end == ' ' || *end == '\t' || *end == '\r') end++;
+    return *end == '\0';
+}
+
+bool MnistCsvReader::open(const std::string& path) {
+    in_.open(path);
+    bad_ = 0;
+    return static_cast<bool>(in_);
+}
+
+bool MnistCsvReader::next(MnistSample& s) {
+    while (std::getline(in_, line_)) {
+        size_t first = line_.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line_[first] == '#') continue;
+        if (parse_line(line_.substr(first), s)) return true;
+        bad_++;
+    }
+    return false;
+}
+
+bool load_mnist_csv(const std::string& path, std::vector<MnistSample>& out, size_t* bad_lines) {
+    MnistCsvReader reader;
+    if (!reader.open(path)) return false;
+    MnistSample s;
+    while (reader.next(s)) out.push_back(s);
+    if (bad_lines) *bad_lines = reader.bad_lines();
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Amostra rotulada no mesmo formato de test/mnist_test_samples.txt
+struct MnistSample {
+    uint8_t label = 0;
+    std::array<uint8_t, 784> pixels{};
+};
+
+// Lê "label,p1,...,p784" por linha, ignorando comentários (#) e linhas vazias
+// Retorna false se o arquivo não abrir; linhas malformadas são contadas em *bad_lines
+bool load_mnist_csv(const std::string& path, std::vector<MnistSample>& out, size_t* bad_lines = nullptr);
+
+// Mesmo formato, uma amostra por vez: pra datasets que não cabem (ou não precisam) na memória
+class MnistCsvReader {
+public:
+    bool open(const std::string& path);
+    // false no fim do arquivo
+    bool next(MnistSample& s);
+    size_t bad_lines() const { return bad_; }
+
+private:
+    std::ifstream in_;
+    std::string line_;
+    size_t bad_ = 0;
+};
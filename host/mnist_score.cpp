@@ -0,0 +1,281 @@
+// Pontuação offline de um dataset inteiro com o modelo int8, sem device: o .tflite é
+// executado pelo TfliteEngine (mesma aritmética do TFLM), com a mesma quantização da
+// entrada (LUT do quantize_f32_to_i8) e o mesmo pós-processamento (argmax, softmax)
+// do firmware. Várias threads, cada uma com sua Workspace e sua matriz de confusão
+//   mnist_score <modelo.tflite> <dataset> [opções]
+// Saída: 0 ok, 1 logits diferentes do --ref-logits, 2 uso/arquivos
+#include "mnist_dataset.h"
+#include "tflite_engine.h"
+#include "mnist_kernels.h"
+#include "eval_stats.h"
+#include "serial_proto.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string model;
+    std::string dataset;        // CSV (label,p1..p784) ou imagens IDX (train/t10k-images-idx3-ubyte)
+    std::string labels;         // rótulos IDX que acompanham as imagens
+    std::string out;            // CSV opcional com o resultado de cada amostra
+    std::string logits;         // logits de cada amostra no formato do --ref-logits
+    std::string ref_logits;     // logits do TFLite (notebook, seção 13.1) pra conferir
+    int threads = 0;            // 0 = hardware_concurrency
+    int repeat = 1;
+    bool scalar = false;        // ignora o AVX2
+};
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "uso: %s <modelo.tflite> <dataset> [opções]\n"
+        "  dataset: CSV label,p1..p784 ou imagens IDX (idx3-ubyte)\n"
+        "  --labels ARQ      rótulos IDX (idx1-ubyte) das imagens IDX\n"
+        "  --threads N       threads de inferência (padrão: todos os núcleos)\n"
+        "  --repeat N        passa o dataset N vezes (só pra medir vazão)\n"
+        "  --out ARQ         grava indice,label,predito,confianca_x10 por amostra\n"
+        "  --logits ARQ      grava label,l0..l9 por amostra (formato do --ref-logits)\n"
+        "  --ref-logits ARQ  confere os logits com os do TFLite, amostra a amostra\n"
+        "  --scalar          não usa AVX2 (caminho escalar)\n",
+        argv0);
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    std::vector<std::string> pos;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--labels" && (v = next())) o.labels = v;
+        else if (a == "--threads" && (v = next())) o.threads = std::max(0, std::atoi(v));
+        else if (a == "--repeat" && (v = next())) o.repeat = std::max(1, std::atoi(v));
+        else if (a == "--out" && (v = next())) o.out = v;
+        else if (a == "--logits" && (v = next())) o.logits = v;
+        else if (a == "--ref-logits" && (v = next())) o.ref_logits = v;
+        else if (a == "--scalar") o.scalar = true;
+        else if (a.rfind("--", 0) == 0) return false;
+        else pos.push_back(a);
+    }
+    if (pos.size() != 2) return false;
+    o.model = pos[0];
+    o.dataset = pos[1];
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// IDX (formato original do MNIST): cabeçalho big-endian, magic 0x803 imagens, 0x801 rótulos
+
+static uint32_t be32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+static bool read_file(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool is_idx_images(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    uint8_t h[4] = {};
+    return f.read(reinterpret_cast<char*>(h), 4) && be32(h) == 0x803;
+}
+
+static bool load_idx(const std::string& images, const std::string& labels, std::vector<MnistSample>& out) {
+    std::vector<uint8_t> img, lab;
+    if (!read_file(images, img) || img.size() < 16 || be32(img.data()) != 0x803) return false;
+    const uint32_t n = be32(img.data() + 4);
+    if (be32(img.data() + 8) != 28 || be32(img.data() + 12) != 28 || img.size() < 16 + static_cast<size_t>(n) * 784) return false;
+    if (!labels.empty()) {
+        if (!read_file(labels, lab) || lab.size() < 8 || be32(lab.data()) != 0x801) return false;
+        if (be32(lab.data() + 4) != n || lab.size() < 8 + static_cast<size_t>(n)) return false;
+    }
+    out.resize(n);
+    for (uint32_t k = 0; k < n; k++) {
+        out[k].label = lab.empty() ? 0 : lab[8 + k];
+        std::memcpy(out[k].pixels.data(), img.data() + 16 + static_cast<size_t>(k) * 784, 784);
+    }
+    return true;
+}
+
+// "label,l0,...,l9" por linha (mesmo formato do kernel_check)
+static bool load_logits(const std::string& path, std::vector<std::vector<int8_t>>& out, std::vector<int>& labels) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::stringstream ss(line);
+        std::string field;
+        std::vector<int> f;
+        while (std::getline(ss, field, ',')) f.push_back(std::atoi(field.c_str()));
+        if (f.size() < 2) return false;
+        labels.push_back(f[0]);
+        out.emplace_back(f.begin() + 1, f.end());
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    TfliteEngine engine;
+    if (!engine.load(opt.model)) {
+        std::fprintf(stderr, "erro: %s: %s\n", opt.model.c_str(), engine.error().c_str());
+        return 2;
+    }
+    if (opt.scalar) engine.set_vector(false);
+    if (engine.input_bytes() != 784) {
+        std::fprintf(stderr, "erro: entrada do modelo tem %d bytes, esperava 28x28\n", engine.input_bytes());
+        return 2;
+    }
+    const int n_out = engine.output_bytes();
+
+    std::vector<MnistSample> samples;
+    const bool idx = is_idx_images(opt.dataset);
+    size_t bad = 0;
+    if (idx ? !load_idx(opt.dataset, opt.labels, samples) : !load_mnist_csv(opt.dataset, samples, &bad)) {
+        std::fprintf(stderr, "erro: nao consegui ler amostras de %s\n", opt.dataset.c_str());
+        return 2;
+    }
+    if (bad) std::fprintf(stderr, "aviso: %zu linhas malformadas ignoradas\n", bad);
+    if (samples.empty()) {
+        std::fprintf(stderr, "erro: %s sem amostras\n", opt.dataset.c_str());
+        return 2;
+    }
+    const bool labeled = !idx || !opt.labels.empty();
+
+    std::vector<std::vector<int8_t>> ref;
+    std::vector<int> ref_labels;
+    if (!opt.ref_logits.empty() && !load_logits(opt.ref_logits, ref, ref_labels)) {
+        std::fprintf(stderr, "erro: nao li %s\n", opt.ref_logits.c_str());
+        return 2;
+    }
+
+    // Mesma quantização do device: LUT com o scale/zero point da entrada do modelo
+    int8_t lut[256];
+    build_input_lut(lut, engine.input_scale(), engine.input_zero_point());
+
+    const size_t n = samples.size();
+    const int threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int8_t> logits(n * static_cast<size_t>(n_out));
+    std::vector<uint8_t> pred(n);
+    std::vector<eval_stats_t> ev(static_cast<size_t>(threads));
+
+    // Blocos de amostras distribuídos por um contador atômico; a primeira passada
+    // grava logits e matriz de confusão, as repetições só contam tempo
+    const size_t chunk = 256;
+    const size_t total = n * static_cast<size_t>(opt.repeat);
+    std::atomic<size_t> next{0};
+    auto worker = [&](int t) {
+        auto ws = engine.make_workspace();
+        std::vector<int8_t> in(784), scratch(static_cast<size_t>(n_out));
+        eval_reset(&ev[t]);
+        for (;;) {
+            const size_t begin = next.fetch_add(chunk);
+            if (begin >= total) break;
+            const size_t end = std::min(total, begin + chunk);
+            for (size_t g = begin; g < end; g++) {
+                const size_t k = g % n;
+                const uint8_t* px = samples[k].pixels.data();
+                for (int i = 0; i < 784; i++) in[i] = lut[px[i]];
+                if (g >= n) {
+                    engine.run(*ws, in.data(), scratch.data());
+                    continue;
+                }
+                int8_t* out = logits.data() + k * static_cast<size_t>(n_out);
+                engine.run(*ws, in.data(), out);
+                pred[k] = static_cast<uint8_t>(argmax_i8(out, n_out));
+                if (labeled) eval_add(&ev[t], samples[k].label, pred[k], 0);
+            }
+        }
+    };
+    const auto t0 = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+    for (std::thread& th : pool) th.join();
+    const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    eval_stats_t all;
+    eval_reset(&all);
+    for (const eval_stats_t& e : ev) {
+        for (int r = 0; r < EVAL_CLASSES; r++)
+            for (int c = 0; c < EVAL_CLASSES; c++) all.cm[r][c] += e.cm[r][c];
+        all.total += e.total;
+        all.correct += e.correct;
+    }
+    // tempo em ms na linha E, pra taxa sair certa no eval_dump
+    all.first_us = 0;
+    all.last_us = static_cast<uint32_t>(std::min(secs * 1e6 * static_cast<double>(n) / static_cast<double>(total), 4e9));
+
+    if (!opt.out.empty() || !opt.logits.empty()) {
+        std::ofstream out, lg;
+        if (!opt.out.empty()) {
+            out.open(opt.out);
+            out << "indice,label,predito,confianca_x10\n";
+        }
+        if (!opt.logits.empty()) lg.open(opt.logits);
+        if ((!opt.out.empty() && !out) || (!opt.logits.empty() && !lg)) {
+            std::fprintf(stderr, "erro: nao consegui gravar a saida por amostra\n");
+            return 2;
+        }
+        float probs[EVAL_CLASSES];
+        for (size_t k = 0; k < n; k++) {
+            const int8_t* l = logits.data() + k * static_cast<size_t>(n_out);
+            if (out.is_open()) {
+                softmax_i8_to_probs(l, engine.output_scale(), engine.output_zero_point(), probs, std::min(n_out, EVAL_CLASSES));
+                out << k << ',' << (labeled ? int(samples[k].label) : -1) << ',' << int(pred[k]) << ','
+                    << static_cast<int>(probs[pred[k] % EVAL_CLASSES] * 10.0f) << '\n';
+            }
+            if (lg.is_open()) {
+                lg << int(samples[k].label);
+                for (int i = 0; i < n_out; i++) lg << ',' << int(l[i]);
+                lg << '\n';
+            }
+        }
+    }
+
+    size_t mismatches = 0;
+    if (!ref.empty()) {
+        const size_t m = std::min(ref.size(), n);
+        for (size_t k = 0; k < m; k++) {
+            const int8_t* l = logits.data() + k * static_cast<size_t>(n_out);
+            const bool same = ref[k].size() == static_cast<size_t>(n_out) && std::equal(l, l + n_out, ref[k].begin()) &&
+                              (!labeled || ref_labels[k] == samples[k].label);
+            if (!same && ++mismatches <= 10) std::fprintf(stderr, "amostra %zu: logits diferentes do TFLite\n", k);
+        }
+        std::printf("ref:      %zu/%zu amostras com os logits do TFLite\n", m - mismatches, m);
+    }
+
+    // Mesmo CRC do $SELFTEST do device, pra conferir um com o outro
+    const uint32_t crc = proto_crc32(0, reinterpret_cast<const uint8_t*>(logits.data()), static_cast<uint32_t>(logits.size()));
+    std::printf("modelo:   %s, %s\n", opt.model.c_str(), engine.vector() ? "AVX2" : "escalar");
+    std::printf("amostras: %zu x %d, %d threads, %.3f s\n", n, opt.repeat, threads, secs);
+    std::printf("crc32:    %08x (logits em ordem)\n", crc);
+    std::printf("vazao:    %.0f imagens/s (%.2f milhoes/min)\n", static_cast<double>(total) / secs,
+                static_cast<double>(total) / secs * 60e-6);
+    if (labeled) {
+        std::printf("acuracia: %.2f%% (%u/%u)\n", 100.0 * all.correct / std::max<uint32_t>(all.total, 1), all.correct, all.total);
+        eval_dump(&all);
+    }
+    return mismatches ? 1 : 0;
+}
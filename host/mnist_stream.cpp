@@ -0,0 +1,460 @@
+// Cliente de streaming: envia um dataset CSV pro device pelo protocolo com id
+// e mede latência ponta a ponta, vazão, acurácia e uso do link
+#include "mnist_dataset.h"
+#include "serial_link.h"
+#include "mnist_codec.h"
+#include "serial_proto.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string device;
+    std::string dataset;
+    std::string results;     // CSV opcional com o resultado de cada amostra
+    int baud = 0;            // 0 = não mexe (USB CDC / pty)
+    double rate = 0.0;       // amostras/s, 0 = o mais rápido possível
+    int window = 0;          // 0 = usa a janela anunciada pelo device
+    char encoding = 'A';     // C, R, S ou A (automática por amostra)
+    size_t count = 0;        // 0 = dataset inteiro
+    int repeat = 1;
+    int timeout_ms = 3000;
+    int retries = 3;
+    bool eval = false;       // usa o modo avaliação do device e imprime a matriz de confusão
+    bool stats = false;      // zera e imprime a telemetria por estágio do device ($STATS)
+    std::string bench;       // CSV acumulado de benchmarks (uma linha por execução)
+    std::string tag = "modelo";  // nome da variante gravado no --bench
+};
+
+struct InFlight {
+    size_t sample;
+    Clock::time_point sent;
+    int attempts;
+};
+
+struct Result {
+    uint32_t id;
+    int label;
+    int pred;
+    double latency_us;
+    int conf_x10;
+    int rx_bytes;
+    long decode_us;
+};
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "uso: %s <device> <dataset.csv> [opções]\n"
+        "  --baud N        configura a velocidade da UART (padrão: não altera)\n"
+        "  --rate HZ       limita a taxa de envio (padrão: o mais rápido possível)\n"
+        "  --window N      limita requisições em voo (padrão: janela do device)\n"
+        "  --encoding E    csv | rle | sparse | auto (padrão: auto)\n"
+        "  --count N       envia só as N primeiras amostras\n"
+        "  --repeat N      repete o dataset N vezes\n"
+        "  --timeout MS    tempo até reenviar uma requisição sem resposta (padrão: 3000)\n"
+        "  --retries N     reenvios por amostra antes de desistir (padrão: 3)\n"
+        "  --results ARQ   grava id,label,pred,latencia_us,... por amostra\n"
+        "  --eval          acumula a matriz de confusão no device e imprime no final\n"
+        "  --stats         imprime a telemetria por estágio do device no final\n"
+        "  --bench ARQ     acrescenta uma linha de resumo (latência, acurácia, invoke) em ARQ\n"
+        "  --tag NOME      nome da variante do modelo nessa linha (padrão: modelo)\n",
+        argv0);
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    std::vector<std::string> pos;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&](void) -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--baud" && (v = next())) o.baud = std::atoi(v);
+        else if (a == "--rate" && (v = next())) o.rate = std::atof(v);
+        else if (a == "--window" && (v = next())) o.window = std::atoi(v);
+        else if (a == "--count" && (v = next())) o.count = std::strtoul(v, nullptr, 10);
+        else if (a == "--repeat" && (v = next())) o.repeat = std::max(1, std::atoi(v));
+        else if (a == "--timeout" && (v = next())) o.timeout_ms = std::atoi(v);
+        else if (a == "--retries" && (v = next())) o.retries = std::atoi(v);
+        else if (a == "--results" && (v = next())) o.results = v;
+        else if (a == "--eval") o.eval = true;
+        else if (a == "--stats") o.stats = true;
+        else if (a == "--bench" && (v = next())) o.bench = v;
+        else if (a == "--tag" && (v = next())) o.tag = v;
+        else if (a == "--encoding" && (v = next())) {
+            std::string e = v;
+            if (e == "csv") o.encoding = CODEC_CSV;
+            else if (e == "rle") o.encoding = CODEC_RLE;
+            else if (e == "sparse") o.encoding = CODEC_SPARSE;
+            else if (e == "auto") o.encoding = 'A';
+            else return false;
+        }
+        else if (!a.empty() && a[0] == '-') return false;
+        else pos.push_back(a);
+    }
+    if (pos.size() != 2) return false;
+    o.device = pos[0];
+    o.dataset = pos[1];
+    return true;
+}
+
+// Monta "@<id>,[E,]<label>,<dados>*<crc>" na codificação pedida
+static std::string build_frame(uint32_t id, const MnistSample& s, char encoding) {
+    static char data[4096];
+    char enc = encoding;
+    if (enc == 'A') {
+        codec_encode_best(s.pixels.data(), data, sizeof(data), &enc);
+    } else if (enc == CODEC_RLE) {
+        codec_encode_rle(s.pixels.data(), data, sizeof(data));
+    } else if (enc == CODEC_SPARSE) {
+        codec_encode_sparse(s.pixels.data(), data, sizeof(data));
+    } else {
+        codec_encode_csv(s.pixels.data(), data, sizeof(data));
+    }
+    std::string body = std::to_string(id) + ",";
+    if (enc != CODEC_CSV) {
+        body += enc;
+        body += ",";
+    }
+    body += std::to_string(s.label) + "," + data;
+    char crc[8];
+    std::snprintf(crc, sizeof(crc), "*%04X", proto_crc16(body.data(), static_cast<int>(body.size())));
+    return "@" + body + crc;
+}
+
+// Separa uma linha "X,a,b,c" em campos
+static std::vector<std::string> split_fields(const std::string& line) {
+    std::vector<std::string> f;
+    size_t start = 0;
+    for (;;) {
+        size_t comma = line.find(',', start);
+        f.push_back(line.substr(start, comma - start));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return f;
+}
+
+// Pede "$EVAL DUMP" e imprime a matriz (M) e precision/recall (P) até "E,END"
+static bool print_device_eval(SerialLink& link) {
+    link.write_line("$EVAL DUMP");
+    std::string line;
+    bool header = false;
+    while (link.read_line(line, 3000)) {
+        auto f = split_fields(line);
+        if (f[0] == "E" && f.size() >= 6) {
+            header = true;
+            std::printf("\navaliacao no device: %s amostras, %s acertos (%.1f%%), %.1f amostras/s sustentadas\n",
+                        f[1].c_str(), f[2].c_str(), std::atoi(f[3].c_str()) / 10.0, std::atoi(f[5].c_str()) / 10.0);
+            std::printf("real\\pred");
+            for (int c = 0; c < 10; c++) std::printf("%6d", c);
+            std::printf("\n");
+        } else if (f[0] == "M" && f.size() >= 12) {
+            std::printf("%9s", f[1].c_str());
+            for (size_t c = 2; c < 12; c++) std::printf("%6s", f[c].c_str());
+            std::printf("\n");
+        } else if (f[0] == "P" && f.size() >= 4) {
+            std::printf("classe %s: precision %.3f recall %.3f\n", f[1].c_str(),
+                        std::atoi(f[2].c_str()) / 1000.0, std::atoi(f[3].c_str()) / 1000.0);
+        } else if (f[0] == "E" && f.size() == 2 && f[1] == "END") {
+            return header;
+        }
+    }
+    return false;
+}
+
+// Limite superior (µs) do bucket que contém o percentil p do histograma log2
+static unsigned long bucket_percentile(const std::vector<std::string>& f, size_t first, unsigned long n, double p) {
+    unsigned long target = static_cast<unsigned long>(p * static_cast<double>(n) + 0.5), acc = 0;
+    for (size_t b = first; b < f.size(); b++) {
+        acc += std::strtoul(f[b].c_str(), nullptr, 10);
+        if (acc >= target && acc > 0) return 2ul << (b - first);
+    }
+    return 0;
+}
+
+// Pede "$STATS" e imprime os estágios (S) e contadores (C) até "S,END"
+// invoke_us recebe o tempo médio de invoke por amostra (0 se não deu pra calcular)
+static bool print_device_stats(SerialLink& link, double* invoke_us) {
+    link.write_line("$STATS");
+    std::string line;
+    bool any = false;
+    double invoke_sum = 0.0;
+    unsigned long invokes = 0, samples = 0;
+    while (link.read_line(line, 3000)) {
+        auto f = split_fields(line);
+        if (f[0] == "ERR") return false;  // firmware compilado com CNN_TELEMETRY=0
+        if (f[0] == "S" && f.size() == 2 && f[1] == "END") {
+            // Com batch > 1 um invoke cobre várias amostras: custo por amostra é o que importa
+            if (invokes && samples) {
+                *invoke_us = invoke_sum / static_cast<double>(samples);
+                std::printf("invoke por amostra: %.1f us (%lu invokes, %.2f amostras/invoke)\n",
+                            invoke_sum / static_cast<double>(samples), invokes,
+                            static_cast<double>(samples) / static_cast<double>(invokes));
+            }
+            return any;
+        }
+        if (f[0] == "S" && f.size() >= 7) {
+            if (!any) std::printf("\n%-8s %8s %10s %8s %8s %8s %8s\n", "estagio", "n", "media_us", "min_us", "max_us", "p50<", "p99<");
+            any = true;
+            unsigned long n = std::strtoul(f[2].c_str(), nullptr, 10);
+            double mean = n ? std::strtod(f[3].c_str(), nullptr) / static_cast<double>(n) : 0.0;
+            if (f[1] == "invoke") {
+                invokes = n;
+                invoke_sum = std::strtod(f[3].c_str(), nullptr);
+            }
+            std::printf("%-8s %8lu %10.1f %8s %8s %8lu %8lu\n", f[1].c_str(), n, mean, f[4].c_str(), f[5].c_str(),
+                        bucket_percentile(f, 6, n, 0.50), bucket_percentile(f, 6, n, 0.99));
+        } else if (f[0] == "C" && f.size() >= 3) {
+            if (f[1] == "samples") samples = std::strtoul(f[2].c_str(), nullptr, 10);
+            std::printf("%-12s %s\n", f[1].c_str(), f[2].c_str());
+        }
+    }
+    return false;
+}
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = static_cast<size_t>(p * static_cast<double>(v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + static_cast<long>(k), v.end());
+    return v[k];
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<MnistSample> base;
+    size_t bad = 0;
+    if (!load_mnist_csv(opt.dataset, base, &bad) || base.empty()) {
+        std::fprintf(stderr, "erro: nao consegui ler amostras de %s\n", opt.dataset.c_str());
+        return 1;
+    }
+    if (bad) std::fprintf(stderr, "aviso: %zu linhas malformadas ignoradas\n", bad);
+    if (opt.count && opt.count < base.size()) base.resize(opt.count);
+    const size_t total = base.size() * static_cast<size_t>(opt.repeat);
+
+    SerialLink link;
+    if (!link.open(opt.device, opt.baud)) {
+        std::fprintf(stderr, "erro: nao consegui abrir %s\n", opt.device.c_str());
+        return 1;
+    }
+
+    // Descobre a janela do device (W,<janela>,<livres>)
+    int window = 0;
+    std::string line;
+    for (int attempt = 0; attempt < 3 && window == 0; attempt++) {
+        link.write_line("@?");
+        auto deadline = Clock::now() + std::chrono::seconds(2);
+        while (window == 0 && Clock::now() < deadline) {
+            if (!link.read_line(line, 200)) continue;
+            if (line.rfind("W,", 0) == 0) {
+                auto f = split_fields(line);
+                if (f.size() >= 2) window = std::atoi(f[1].c_str());
+            }
+        }
+    }
+    if (window <= 0) {
+        std::fprintf(stderr, "erro: device nao respondeu a consulta de janela (@?)\n");
+        return 1;
+    }
+    if (opt.window > 0) window = std::min(window, opt.window);
+    std::fprintf(stderr, "janela: %d requisicoes em voo, %zu amostras\n", window, total);
+
+    if (opt.stats) link.write_line("$STATS RESET");
+    if (opt.eval) {
+        link.write_line("$EVAL RESET");
+        link.write_line("$EVAL ON");
+    }
+
+    std::unordered_map<uint32_t, InFlight> inflight;
+    std::deque<uint32_t> resend;       // ids que levaram NAK ou timeout
+    std::vector<size_t> id_sample;     // id -> índice da amostra (id = posição + 1)
+    std::vector<Result> results;
+    results.reserve(total);
+    size_t next_sample = 0;
+    size_t failed = 0, naks = 0, timeouts = 0, retransmits = 0, unparsed = 0;
+    size_t payload_bytes = 0;
+
+    const auto period = (opt.rate > 0.0)
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / opt.rate))
+        : Clock::duration::zero();
+    const auto t_start = Clock::now();
+    auto next_send = t_start;
+    auto t_last = t_start;
+    const size_t rx_before = link.bytes_received();
+    const size_t tx_before = link.bytes_sent();
+
+    auto send = [&](uint32_t id, int attempts) {
+        const MnistSample& s = base[id_sample[id - 1] % base.size()];
+        std::string frame = build_frame(id, s, opt.encoding);
+        payload_bytes += frame.size() + 1;
+        link.write_line(frame);
+        inflight[id] = InFlight{id_sample[id - 1], Clock::now(), attempts};
+    };
+    auto retry_or_fail = [&](uint32_t id) {
+        auto it = inflight.find(id);
+        if (it == inflight.end()) return;
+        if (it->second.attempts > opt.retries) {
+            failed++;
+            inflight.erase(it);
+        } else {
+            resend.push_back(id);
+        }
+    };
+
+    while (results.size() + failed < total) {
+        auto now = Clock::now();
+        // Envia enquanto houver crédito e o ritmo permitir
+        while (static_cast<int>(inflight.size() - resend.size()) < window && now >= next_send) {
+            if (!resend.empty()) {
+                uint32_t id = resend.front();
+                resend.pop_front();
+                int attempts = inflight[id].attempts + 1;
+                retransmits++;
+                send(id, attempts);
+            } else if (next_sample < total) {
+                id_sample.push_back(next_sample++);
+                send(static_cast<uint32_t>(id_sample.size()), 1);
+            } else {
+                break;
+            }
+            if (period > Clock::duration::zero()) {
+                next_send += period;
+                if (next_send < now) next_send = now;  // sem rajadas depois de ficar sem crédito
+            }
+        }
+
+        // Espera resposta no máximo até o próximo envio programado
+        int wait_ms = 50;
+        if (period > Clock::duration::zero() && next_sample < total) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(next_send - Clock::now()).count();
+            wait_ms = static_cast<int>(std::clamp<long long>(ms, 0, 50));
+        }
+        if (link.read_line(line, wait_ms)) {
+            auto f = split_fields(line);
+            if (f[0] == "R" && f.size() >= 8) {
+                uint32_t id = static_cast<uint32_t>(std::strtoul(f[1].c_str(), nullptr, 10));
+                auto it = inflight.find(id);
+                if (it != inflight.end()) {
+                    auto lat = std::chrono::duration<double, std::micro>(Clock::now() - it->second.sent).count();
+                    results.push_back(Result{id, base[it->second.sample % base.size()].label,
+                                             std::atoi(f[2].c_str()), lat, std::atoi(f[4].c_str()),
+                                             std::atoi(f[5].c_str()), std::atol(f[6].c_str())});
+                    // descarta um reenvio pendente do mesmo id (a resposta chegou atrasada)
+                    resend.erase(std::remove(resend.begin(), resend.end(), id), resend.end());
+                    inflight.erase(it);
+                    t_last = Clock::now();
+                }
+            } else if (f[0] == "N" && f.size() >= 3) {
+                naks++;
+                if (f[1] != "?") retry_or_fail(static_cast<uint32_t>(std::strtoul(f[1].c_str(), nullptr, 10)));
+            } else if (f[0] != "W" && f[0] != "OK") {
+                unparsed++;  // texto livre do firmware (modo verboso, avisos)
+            }
+        }
+
+        // Reenvia (ou desiste de) requisições sem resposta
+        now = Clock::now();
+        for (auto& [id, inf] : inflight) {
+            if (now - inf.sent > std::chrono::milliseconds(opt.timeout_ms) &&
+                std::find(resend.begin(), resend.end(), id) == resend.end()) {
+                timeouts++;
+                inf.sent = now;
+                if (inf.attempts > opt.retries) {
+                    failed++;
+                    inf.attempts = -1;  // marcado pra remoção abaixo
+                } else {
+                    resend.push_back(id);
+                }
+            }
+        }
+        for (auto it = inflight.begin(); it != inflight.end();) {
+            it = (it->second.attempts < 0) ? inflight.erase(it) : std::next(it);
+        }
+    }
+
+    // Estatísticas
+    const double elapsed = std::chrono::duration<double>(t_last - t_start).count();
+    std::vector<double> lat;
+    size_t correct = 0;
+    double decode_sum = 0.0, rx_frame_sum = 0.0;
+    for (const auto& r : results) {
+        lat.push_back(r.latency_us);
+        if (r.pred == r.label) correct++;
+        decode_sum += static_cast<double>(r.decode_us);
+        rx_frame_sum += r.rx_bytes;
+    }
+    double lat_mean = 0.0;
+    for (double v : lat) lat_mean += v;
+    if (!lat.empty()) lat_mean /= static_cast<double>(lat.size());
+    const size_t tx = link.bytes_sent() - tx_before;
+    const size_t rx = link.bytes_received() - rx_before;
+    const size_t n = results.size();
+
+    std::printf("amostras:      %zu ok, %zu falharam (%zu NAK, %zu timeouts, %zu reenvios)\n",
+                n, failed, naks, timeouts, retransmits);
+    std::printf("vazao:         %.1f amostras/s em %.3f s\n", elapsed > 0 ? static_cast<double>(n) / elapsed : 0.0, elapsed);
+    std::printf("latencia (ms): media %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+                lat_mean / 1000.0, percentile(lat, 0.50) / 1000.0, percentile(lat, 0.90) / 1000.0,
+                percentile(lat, 0.99) / 1000.0, percentile(lat, 1.0) / 1000.0);
+    std::printf("acuracia:      %.2f%% (%zu/%zu)\n", n ? 100.0 * static_cast<double>(correct) / static_cast<double>(n) : 0.0, correct, n);
+    std::printf("link:          tx %zu B (%.0f B/s), rx %zu B (%.0f B/s), %.0f B/requisicao\n",
+                tx, elapsed > 0 ? static_cast<double>(tx) / elapsed : 0.0,
+                rx, elapsed > 0 ? static_cast<double>(rx) / elapsed : 0.0,
+                (n + retransmits) ? static_cast<double>(payload_bytes) / static_cast<double>(n + retransmits) : 0.0);
+    if (opt.baud > 0 && elapsed > 0) {
+        // UART 8N1: 10 bits por byte
+        const double cap = static_cast<double>(opt.baud) / 10.0 * elapsed;
+        std::printf("uso do link:   tx %.1f%%, rx %.1f%% de %d baud\n",
+                    100.0 * static_cast<double>(tx) / cap, 100.0 * static_cast<double>(rx) / cap, opt.baud);
+    }
+    if (n) {
+        std::printf("device:        decodificacao media %.1f us, frame medio %.0f B\n",
+                    decode_sum / static_cast<double>(n), rx_frame_sum / static_cast<double>(n));
+    }
+    if (unparsed) std::printf("linhas ignoradas: %zu\n", unparsed);
+
+    if (opt.eval) {
+        if (!print_device_eval(link)) std::fprintf(stderr, "aviso: device nao devolveu a avaliacao\n");
+        link.write_line("$EVAL OFF");
+    }
+
+    double invoke_us = 0.0;
+    if (opt.stats && !print_device_stats(link, &invoke_us)) {
+        std::fprintf(stderr, "aviso: device sem telemetria (CNN_TELEMETRY=0?)\n");
+    }
+
+    if (!opt.bench.empty()) {
+        // Uma linha por execução: o notebook junta pelo nome da variante pra montar a curva de Pareto
+        bool header = !std::ifstream(opt.bench).good();
+        std::ofstream out(opt.bench, std::ios::app);
+        if (header) out << "modelo,amostras,acuracia,amostras_s,lat_p50_us,lat_p99_us,invoke_us\n";
+        out << opt.tag << ',' << n << ',' << (n ? static_cast<double>(correct) / static_cast<double>(n) : 0.0) << ','
+            << (elapsed > 0 ? static_cast<double>(n) / elapsed : 0.0) << ','
+            << static_cast<long>(percentile(lat, 0.50)) << ',' << static_cast<long>(percentile(lat, 0.99)) << ',';
+        if (invoke_us > 0.0) out << static_cast<long>(invoke_us + 0.5);  // vazio sem --stats
+        out << '\n';
+    }
+
+    if (!opt.results.empty()) {
+        std::ofstream out(opt.results);
+        out << "id,label,pred,latencia_us,conf_x10,rx_bytes,decode_us\n";
+        for (const auto& r : results) {
+            out << r.id << ',' << r.label << ',' << r.pred << ',' << static_cast<long>(r.latency_us) << ','
+                << r.conf_x10 << ',' << r.rx_bytes << ',' << r.decode_us << '\n';
+        }
+    }
+    return failed ? 3 : 0;
+}
@@ -0,0 +1,167 @@
+// Grava um .tflite na partição de modelos do device ($MODEL, ver firmware/model_store.h)
+//   model_upload /dev/ttyACM0 modelo.tflite [--baud N] [--chunk N]
+// Manda em pedaços com CRC-16 (reenvia o que falhar), pede o COMMIT, espera o
+// device reiniciar e confere pelo $MODEL que ele subiu com o modelo novo
+// Saída: 0 ok, 1 erro de comunicação, 2 uso, 3 modelo recusado (COMMIT ou boot)
+#include "serial_link.h"
+#include "serial_proto.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+static const char* usage = "uso: %s <porta> <modelo.tflite> [--baud N] [--chunk N]\n";
+
+// Espera a próxima linha que começa com um dos prefixos (o resto é log do firmware)
+static bool wait_reply(SerialLink& link, std::string& line, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!link.read_line(line, 200)) continue;
+        if (line.rfind("OK,MODEL", 0) == 0 || line.rfind("ERR,MODEL", 0) == 0) return true;
+    }
+    return false;
+}
+
+// Pergunta o modelo ativo: MODEL,ACTIVE,<FLASH|BUILTIN>,<slot>,<bytes>,<crc32>
+static bool query_active(SerialLink& link, std::string& source, int& slot, unsigned long& crc) {
+    link.write_line("$MODEL");
+    std::string line;
+    for (int i = 0; i < 50; i++) {
+        if (!link.read_line(line, 200)) continue;
+        char src[16] = {0};
+        unsigned long bytes = 0;
+        if (std::sscanf(line.c_str(), "MODEL,ACTIVE,%15[^,],%d,%lu,%lx", src, &slot, &bytes, &crc) == 4) {
+            source = src;
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string hex_chunk(const std::string& data, size_t off, size_t n) {
+    static const char digits[] = "0123456789abcdef";
+    char head[24];
+    std::snprintf(head, sizeof(head), "%zx,", off);
+    std::string out = head;
+    for (size_t i = off; i < off + n; i++) {
+        unsigned char b = static_cast<unsigned char>(data[i]);
+        out += digits[b >> 4];
+        out += digits[b & 0x0F];
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    std::string port, path;
+    int baud = 0;
+    size_t chunk = 256;  // uma página da flash por linha
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--baud" && i + 1 < argc) baud = std::atoi(argv[++i]);
+        else if (a == "--chunk" && i + 1 < argc) chunk = static_cast<size_t>(std::atoi(argv[++i]));
+        else if (a[0] != '-' && port.empty()) port = a;
+        else if (a[0] != '-' && path.empty()) path = a;
+        else {
+            std::fprintf(stderr, usage, argv[0]);
+            return 2;
+        }
+    }
+    if (port.empty() || path.empty() || chunk == 0 || chunk > 256) {
+        std::fprintf(stderr, usage, argv[0]);
+        return 2;
+    }
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        std::fprintf(stderr, "erro: nao consegui abrir %s\n", path.c_str());
+        return 1;
+    }
+    std::string model(std::istreambuf_iterator<char>(f), {});
+    uint32_t crc = proto_crc32(0, reinterpret_cast<const uint8_t*>(model.data()), static_cast<uint32_t>(model.size()));
+
+    SerialLink link;
+    if (!link.open(port, baud)) {
+        std::fprintf(stderr, "erro: nao consegui abrir %s\n", port.c_str());
+        return 1;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    char cmd[64];
+    std::snprintf(cmd, sizeof(cmd), "$MODEL BEGIN %zu %08lx", model.size(), static_cast<unsigned long>(crc));
+    link.write_line(cmd);
+    std::string line;
+    if (!wait_reply(link, line, 10000) || line.rfind("OK,MODEL,BEGIN", 0) != 0) {
+        std::fprintf(stderr, "erro: BEGIN: %s\n", line.c_str());
+        return 1;
+    }
+    std::printf("slot %s, %zu bytes, crc32 %08lx\n", line.c_str() + 15, model.size(), static_cast<unsigned long>(crc));
+
+    size_t off = 0;
+    int retries = 0;
+    while (off < model.size()) {
+        size_t n = std::min(chunk, model.size() - off);
+        std::string payload = hex_chunk(model, off, n);
+        char tail[8];
+        std::snprintf(tail, sizeof(tail), "*%04x", proto_crc16(payload.data(), static_cast<int>(payload.size())));
+        link.write_line("$MODEL DATA " + payload + tail);
+        unsigned long next = 0;
+        bool ok = wait_reply(link, line, 2000);
+        if (ok && std::sscanf(line.c_str(), "OK,MODEL,DATA,%lx", &next) == 1) {
+            off = next;
+            retries = 0;
+            continue;
+        }
+        // Resposta perdida ou pedaço repetido: o device diz de onde continuar
+        if (ok && std::sscanf(line.c_str(), "ERR,MODEL,OFFSET,%lx", &next) == 1) {
+            off = next;
+            continue;
+        }
+        if (++retries > 5) {
+            std::fprintf(stderr, "erro: DATA em %zx: %s\n", off, ok ? line.c_str() : "timeout");
+            return 1;
+        }
+    }
+
+    link.write_line("$MODEL COMMIT");
+    if (!wait_reply(link, line, 5000)) {
+        std::fprintf(stderr, "erro: COMMIT sem resposta\n");
+        return 1;
+    }
+    int slot = -1;
+    unsigned long seq = 0;
+    if (std::sscanf(line.c_str(), "OK,MODEL,COMMIT,%d,%lu", &slot, &seq) != 2) {
+        std::fprintf(stderr, "modelo recusado: %s\n", line.c_str());
+        return 3;
+    }
+    double up_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("gravado no slot %d (geracao %lu) em %.2f s, reiniciando...\n", slot, seq, up_s);
+
+    // O device reinicia: a porta some e volta (USB CDC / pty novo do simulador)
+    link.close();
+    std::string source;
+    int active = -1;
+    unsigned long active_crc = 0;
+    bool back = false;
+    for (int i = 0; i < 30 && !back; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (!link.open(port, baud)) continue;
+        back = query_active(link, source, active, active_crc);
+        if (!back) link.close();
+    }
+    if (!back) {
+        std::fprintf(stderr, "erro: device nao voltou depois do reinicio\n");
+        return 1;
+    }
+    double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (source != "FLASH" || active != slot || active_crc != crc) {
+        std::fprintf(stderr, "modelo recusado no boot: device rodando %s (slot %d, crc32 %08lx)\n", source.c_str(),
+                     active, active_crc);
+        return 3;
+    }
+    std::printf("ok: rodando o slot %d em %.2f s\n", slot, total_s);
+    return 0;
+}
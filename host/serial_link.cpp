@@ -0,0 +1,118 @@
+#include "serial_link.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+static speed_t baud_to_speed(int baud) {
+    switch (baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        default:      return 0;
+    }
+}
+
+bool serial_make_raw(int fd, int baud) {
+    termios tio{};
+    if (tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (baud > 0) {
+        speed_t sp = baud_to_speed(baud);
+        if (sp == 0) return false;
+        cfsetispeed(&tio, sp);
+        cfsetospeed(&tio, sp);
+    }
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+SerialLink::~SerialLink() { close(); }
+
+bool SerialLink::open(const std::string& path, int baud) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd_ < 0) return false;
+    if (!serial_make_raw(fd_, baud)) {
+        close();
+        return false;
+    }
+    tcflush(fd_, TCIOFLUSH);  // descarta lixo de sessões anteriores
+    return true;
+}
+
+void SerialLink::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    rx_.clear();
+}
+
+bool SerialLink::write_all(const char* data, size_t len) {
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = ::write(fd_, data + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) return false;
+            pollfd p{fd_, POLLOUT, 0};
+            poll(&p, 1, 100);  // buffer do driver cheio, espera esvaziar
+            continue;
+        }
+        off += static_cast<size_t>(n);
+    }
+    bytes_tx_ += len;
+    return true;
+}
+
+bool SerialLink::write_line(const std::string& line) {
+    std::string out = line;
+    out += '\n';
+    return write_all(out.data(), out.size());
+}
+
+bool SerialLink::fill(int timeout_ms) {
+    pollfd p{fd_, POLLIN, 0};
+    int rc = poll(&p, 1, timeout_ms);
+    if (rc <= 0) return false;
+    char buf[4096];
+    ssize_t n = ::read(fd_, buf, sizeof(buf));
+    if (n <= 0) return false;
+    rx_.append(buf, static_cast<size_t>(n));
+    bytes_rx_ += static_cast<size_t>(n);
+    return true;
+}
+
+bool SerialLink::read_line(std::string& line, int timeout_ms) {
+    for (;;) {
+        size_t nl = rx_.find_first_of("\r\n");
+        if (nl != std::string::npos) {
+            line.assign(rx_, 0, nl);
+            // consome só um terminador ("\r\n" ou "\n"): pode vir bloco binário em seguida
+            size_t skip = nl + 1;
+            if (rx_[nl] == '\r' && skip < rx_.size() && rx_[skip] == '\n') skip++;
+            rx_.erase(0, skip);
+            if (line.empty()) continue;  // linhas em branco do firmware
+            return true;
+        }
+        if (!fill(timeout_ms)) return false;
+    }
+}
+
+bool SerialLink::read_bytes(std::string& out, size_t n, int timeout_ms) {
+    while (rx_.size() < n) {
+        if (!fill(timeout_ms)) return false;
+    }
+    out.assign(rx_, 0, n);
+    rx_.erase(0, n);
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Link serial do lado do host (porta real /dev/ttyACM*, /dev/ttyUSB* ou pty)
+class SerialLink {
+public:
+    SerialLink() = default;
+    ~SerialLink();
+    SerialLink(const SerialLink&) = delete;
+    SerialLink& operator=(const SerialLink&) = delete;
+
+    // Abre em modo raw; baud 0 mantém a velocidade atual (USB CDC/pty ignoram)
+    bool open(const std::string& path, int baud);
+    void close();
+    int fd() const { return fd_; }
+
+    bool write_all(const char* data, size_t len);
+    bool write_line(const std::string& line);  // acrescenta '\n'
+
+    // Lê uma linha completa (sem '\r'/'\n'); false se estourou timeout_ms
+    bool read_line(std::string& line, int timeout_ms);
+    // Lê exatamente n bytes crus (blocos binários, ex.: dump do trace)
+    bool read_bytes(std::string& out, size_t n, int timeout_ms);
+
+    size_t bytes_sent() const { return bytes_tx_; }
+    size_t bytes_received() const { return bytes_rx_; }
+
+private:
+    bool fill(int timeout_ms);
+
+    int fd_ = -1;
+    std::string rx_;
+    size_t bytes_tx_ = 0;
+    size_t bytes_rx_ = 0;
+};
+
+// Configura um fd de terminal em modo raw (sem eco, sem tradução de fim de linha)
+bool serial_make_raw(int fd, int baud);
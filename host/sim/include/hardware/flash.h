@@ -0,0 +1,26 @@
+#pragma once
+// Flash do simulador: 2 MB em memória (ou num arquivo com SIM_FLASH=<caminho>, que
+// sobrevive a reinícios), lida direto pelo "XIP" e gravada com a semântica da
+// flash de verdade (apagar põe 0xFF, gravar só derruba bits)
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLASH_PAGE_SIZE        256
+#define FLASH_SECTOR_SIZE      4096
+#define PICO_FLASH_SIZE_BYTES  (2 * 1024 * 1024)
+#define SIM_FLASH_BINARY_BYTES (512 * 1024)  // tamanho fingido da imagem do firmware
+
+uint8_t* sim_flash_base(void);  // mapeia na primeira chamada
+#define XIP_BASE ((uintptr_t)sim_flash_base())
+#define __flash_binary_end (*(char*)(sim_flash_base() + SIM_FLASH_BINARY_BYTES))
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
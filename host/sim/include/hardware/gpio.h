@@ -0,0 +1,21 @@
+#pragma once
+// GPIO do simulador: as chamadas só são aceitas (o I2C não depende dos pinos)
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+};
+
+static inline void gpio_set_function(unsigned gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+static inline void gpio_pull_up(unsigned gpio) { (void)gpio; }
+
+#ifdef __cplusplus
+}
+#endif
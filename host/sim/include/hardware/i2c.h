@@ -0,0 +1,23 @@
+#pragma once
+// I2C do simulador: i2c_write_blocking entrega os bytes pro modelo do SSD1306 (sim_ssd1306.c)
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t* const i2c0;
+extern i2c_inst_t* const i2c1;
+
+unsigned i2c_init(i2c_inst_t* i2c, unsigned baudrate);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+
+#define PICO_ERROR_GENERIC (-1)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+// Sem interrupções no simulador: só mantém a assinatura do SDK
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Eventos entre núcleos (sim_multicore.c): o WFE espera até algum SEV, que fica
+// guardado por núcleo como o registrador de evento do Cortex-M0+
+void __sev(void);
+void __wfe(void);
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+// Reinício do simulador: o processo se reexecuta (pty e symlink novos, flash mantida
+// se estiver em SIM_FLASH); o host tem que reabrir a porta, como com o USB CDC
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+// Substituto do pico/multicore.h: o core1 vira uma thread e as duas FIFOs
+// entre núcleos viram filas com mutex (mesma profundidade do RP2040)
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void multicore_launch_core1(void (*entry)(void));
+// A thread termina quando a entry volta, então não tem o que resetar
+static inline void multicore_reset_core1(void) {}
+
+bool multicore_fifo_rvalid(void);  // tem palavra pra ler na FIFO deste núcleo
+bool multicore_fifo_wready(void);  // cabe palavra na FIFO do outro núcleo
+void multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+
+// Parar o outro núcleo durante escrita na flash: a flash do simulador é memória comum
+static inline void multicore_lockout_victim_init(void) {}
+static inline void multicore_lockout_start_blocking(void) {}
+static inline void multicore_lockout_end_blocking(void) {}
+
+#ifdef __cplusplus
+}
+#endif
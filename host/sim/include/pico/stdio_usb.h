@@ -0,0 +1,5 @@
+#pragma once
+// Substituto do pico/stdio_usb.h: o pty do simulador não tem DTR, conta como terminal aberto
+#include <stdbool.h>
+
+static inline bool stdio_usb_connected(void) { return true; }
@@ -0,0 +1,30 @@
+#pragma once
+// Substituto do pico/stdlib.h pro simulador Linux: só o que o firmware usa
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+// stdin/stdout viram o lado mestre de um pty (ver sim_pico.c)
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);  // PICO_ERROR_TIMEOUT se nada chegou
+void stdio_flush(void);
+int putchar_raw(int c);
+void stdio_set_chars_available_callback(void (*fn)(void*), void* param);  // chamado quando chega algo
+
+#define PICO_ERROR_TIMEOUT (-1)
+
+static inline void tight_loop_contents(void) {}
+uint get_core_num(void);  // 1 na thread do core1 (sim_multicore.c)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+// Relógio do simulador: virtual por padrão (sleep não espera de verdade e o
+// tempo só anda quando o firmware dorme, espera a serial ou roda um invoke)
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+// WFE do escalonador: espera a serial (ou o callback de chegada) até o prazo
+// Retorna true se o prazo venceu
+bool best_effort_wfe_or_timeout(absolute_time_t timeout);
+
+// Só no simulador: cobra us de tempo de CPU no relógio virtual (no modo real não faz nada)
+void sim_clock_advance_us(uint64_t us);
+
+#ifdef __cplusplus
+}
+#endif
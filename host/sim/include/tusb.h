@@ -0,0 +1,9 @@
+#pragma once
+// Substituto do tusb.h: o pty do simulador está sempre "enumerado"
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline bool tud_mounted(void) { return true; }
+// Sem fila de CDC: o stdout do simulador sempre aceita uma linha
+static inline bool tud_cdc_connected(void) { return true; }
+static inline uint32_t tud_cdc_write_available(void) { return 256; }
@@ -0,0 +1,13 @@
+#pragma once
+// Ganchos internos do simulador (não fazem parte do SDK)
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sim_display_init(void);  // lê SIM_FRAMES
+
+#ifdef __cplusplus
+}
+#endif
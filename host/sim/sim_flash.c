@@ -0,0 +1,79 @@
+// Flash e reinício do simulador (ver hardware/flash.h e hardware/watchdog.h)
+#define _GNU_SOURCE
+#include "hardware/flash.h"
+#include "hardware/watchdog.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint8_t* flash = NULL;
+
+uint8_t* sim_flash_base(void) {
+    if (flash) return flash;
+    const char* path = getenv("SIM_FLASH");
+    if (path) {
+        int fd = open(path, O_RDWR | O_CREAT, 0644);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            perror("sim: SIM_FLASH");
+            exit(1);
+        }
+        bool fresh = st.st_size != PICO_FLASH_SIZE_BYTES;
+        if (fresh && ftruncate(fd, PICO_FLASH_SIZE_BYTES) != 0) {
+            perror("sim: SIM_FLASH");
+            exit(1);
+        }
+        flash = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (flash == MAP_FAILED) {
+            perror("sim: mmap");
+            exit(1);
+        }
+        if (fresh) memset(flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+    } else {
+        flash = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (flash == MAP_FAILED) {
+            perror("sim: mmap");
+            exit(1);
+        }
+        memset(flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+    }
+    return flash;
+}
+
+// O SDK exige alinhamento de setor/página; aqui vira erro fatal pra aparecer no teste
+static void check_range(uint32_t offs, size_t count, uint32_t align) {
+    if (offs % align || count % align || offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim: acesso à flash desalinhado (%x, %zu)\n", offs, count);
+        abort();
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    check_range(flash_offs, count, FLASH_SECTOR_SIZE);
+    memset(sim_flash_base() + flash_offs, 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    check_range(flash_offs, count, FLASH_PAGE_SIZE);
+    uint8_t* p = sim_flash_base() + flash_offs;
+    for (size_t i = 0; i < count; i++) p[i] &= data[i];
+}
+
+// O pty é FD_CLOEXEC (sim_pico.c): o processo novo abre outro e refaz o SIM_LINK
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms) {
+    (void)pc;
+    (void)sp;
+    fflush(stdout);
+    usleep(delay_ms * 1000);  // espera de verdade: o host precisa ler a resposta antes do pty sumir
+    fprintf(stderr, "sim: reiniciando\n");
+    execl("/proc/self/exe", "cnn_sim", (char*)NULL);
+    perror("sim: execl");
+    exit(1);
+}
@@ -0,0 +1,101 @@
+// Core1 do simulador: uma pthread rodando a entry do firmware
+//
+// Cada núcleo lê da sua FIFO e escreve na do outro, como no SIO do RP2040.
+// get_core_num() sai de uma variável por thread. Com o relógio virtual os dois
+// núcleos cobram tempo no mesmo contador, então o paralelismo só aparece em
+// vazão com SIM_CLOCK=real
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FIFO_DEPTH 8
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t data[FIFO_DEPTH];
+    int head, count;
+} sim_fifo_t;
+
+// fifos[c] = palavras que o núcleo c lê
+static sim_fifo_t fifos[2] = {
+    {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0},
+    {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0},
+};
+static _Thread_local uint core_num = 0;
+static void (*core1_entry)(void) = NULL;
+
+uint get_core_num(void) { return core_num; }
+
+static void* core1_thread(void* arg) {
+    (void)arg;
+    core_num = 1;
+    core1_entry();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t t;
+    core1_entry = entry;
+    if (pthread_create(&t, NULL, core1_thread, NULL) != 0) {
+        perror("sim: core1");
+        exit(1);
+    }
+    pthread_detach(t);
+}
+
+static int fifo_count(sim_fifo_t* f) {
+    pthread_mutex_lock(&f->lock);
+    int n = f->count;
+    pthread_mutex_unlock(&f->lock);
+    return n;
+}
+
+bool multicore_fifo_rvalid(void) { return fifo_count(&fifos[core_num]) > 0; }
+
+bool multicore_fifo_wready(void) { return fifo_count(&fifos[core_num ^ 1]) < FIFO_DEPTH; }
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    sim_fifo_t* f = &fifos[core_num ^ 1];
+    pthread_mutex_lock(&f->lock);
+    while (f->count == FIFO_DEPTH) pthread_cond_wait(&f->cond, &f->lock);
+    f->data[(f->head + f->count) % FIFO_DEPTH] = data;
+    f->count++;
+    pthread_cond_broadcast(&f->cond);
+    pthread_mutex_unlock(&f->lock);
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    sim_fifo_t* f = &fifos[core_num];
+    pthread_mutex_lock(&f->lock);
+    while (f->count == 0) pthread_cond_wait(&f->cond, &f->lock);
+    uint32_t data = f->data[f->head];
+    f->head = (f->head + 1) % FIFO_DEPTH;
+    f->count--;
+    pthread_cond_broadcast(&f->cond);
+    pthread_mutex_unlock(&f->lock);
+    return data;
+}
+
+// Registrador de evento de cada núcleo: o SEV liga nos dois, o WFE espera e consome
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond = PTHREAD_COND_INITIALIZER;
+static bool events[2];
+
+void __sev(void) {
+    pthread_mutex_lock(&event_lock);
+    events[0] = events[1] = true;
+    pthread_cond_broadcast(&event_cond);
+    pthread_mutex_unlock(&event_lock);
+}
+
+void __wfe(void) {
+    pthread_mutex_lock(&event_lock);
+    while (!events[core_num]) pthread_cond_wait(&event_cond, &event_lock);
+    events[core_num] = false;
+    pthread_mutex_unlock(&event_lock);
+}
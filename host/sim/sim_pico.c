@@ -0,0 +1,146 @@
+// Parte "placa" do simulador: relógio, stdio num pseudo-terminal
+//
+// Configuração por variáveis de ambiente (o main() do firmware não muda):
+//   SIM_LINK=/tmp/cnn_sim   cria um symlink pro lado escravo do pty
+//   SIM_CLOCK=real          usa o relógio do host em vez do virtual
+//   SIM_FLASH=<arquivo>     flash persistente entre execuções (sim_flash.c)
+#define _GNU_SOURCE
+#include "pico/stdlib.h"
+#include "sim.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static bool real_clock = false;
+static _Atomic uint64_t virtual_us = 0;  // os dois núcleos cobram tempo nele
+static uint64_t boot_ns = 0;
+
+static int pty_fd = -1;
+static uint8_t rx_buf[4096];
+static size_t rx_len = 0, rx_pos = 0;
+static void (*chars_cb)(void*) = NULL;
+static void* chars_cb_param = NULL;
+
+static uint64_t host_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+uint64_t time_us_64(void) {
+    if (real_clock) return (host_ns() - boot_ns) / 1000;
+    return virtual_us;
+}
+
+void sim_clock_advance_us(uint64_t us) {
+    if (!real_clock) virtual_us += us;
+}
+
+void sleep_us(uint64_t us) {
+    if (!real_clock) {
+        virtual_us += us;  // ninguém espera: o boot de 2 s passa na hora
+        return;
+    }
+    struct timespec t = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    while (nanosleep(&t, &t) != 0 && errno == EINTR) {}
+}
+
+void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000); }
+
+// Raw no lado escravo: sem eco e sem tradução de fim de linha (igual ao USB CDC)
+static bool make_raw(int fd) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+bool stdio_init_all(void) {
+    boot_ns = host_ns();
+    const char* clock = getenv("SIM_CLOCK");
+    real_clock = clock && strcmp(clock, "real") == 0;
+
+    pty_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pty_fd < 0 || grantpt(pty_fd) != 0 || unlockpt(pty_fd) != 0) {
+        perror("sim: posix_openpt");
+        exit(1);
+    }
+    const char* slave_name = ptsname(pty_fd);
+    // Mantém o escravo aberto: o cliente pode fechar e reabrir sem EIO no mestre
+    fcntl(pty_fd, F_SETFD, FD_CLOEXEC);  // o reinício (watchdog_reboot) cria outro pty
+    int slave = open(slave_name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0 || !make_raw(slave)) {
+        perror("sim: pty");
+        exit(1);
+    }
+    const char* link = getenv("SIM_LINK");
+    if (link) {
+        unlink(link);
+        if (symlink(slave_name, link) != 0) {
+            perror("sim: symlink");
+            exit(1);
+        }
+    }
+    fprintf(stderr, "sim: serial em %s%s%s, relógio %s\n", slave_name, link ? " -> " : "", link ? link : "",
+            real_clock ? "real" : "virtual");
+    sim_display_init();
+
+    fflush(stdout);
+    dup2(pty_fd, STDOUT_FILENO);
+    setvbuf(stdout, NULL, _IOFBF, 4096);  // stdio_flush/getchar esvaziam, como o buffer do USB CDC
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    if (rx_pos < rx_len) return rx_buf[rx_pos++];
+    fflush(stdout);  // o firmware vai esperar: o que ele escreveu tem que chegar no host
+    struct pollfd p = {pty_fd, POLLIN, 0};
+    struct timespec t = {(time_t)(timeout_us / 1000000), (long)(timeout_us % 1000000) * 1000};
+    if (ppoll(&p, 1, &t, NULL) > 0) {
+        ssize_t n = read(pty_fd, rx_buf, sizeof(rx_buf));
+        if (n > 0) {
+            rx_len = (size_t)n;
+            rx_pos = 1;
+            return rx_buf[0];
+        }
+    }
+    sim_clock_advance_us(timeout_us);
+    return PICO_ERROR_TIMEOUT;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void*), void* param) {
+    chars_cb = fn;
+    chars_cb_param = param;
+}
+
+// Dormir no device é esperar uma interrupção; aqui a única fonte é a serial
+// (o SEV do core1 vira o prazo curto que o firmware já pede nesse caso)
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+    uint64_t now = time_us_64();
+    if (timeout <= now) return true;
+    uint64_t us = timeout - now;
+    if (rx_pos < rx_len) {
+        if (chars_cb) chars_cb(chars_cb_param);
+        return false;
+    }
+    fflush(stdout);
+    struct pollfd p = {pty_fd, POLLIN, 0};
+    struct timespec t = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    if (ppoll(&p, 1, &t, NULL) > 0) {
+        if (chars_cb) chars_cb(chars_cb_param);
+        return false;
+    }
+    sim_clock_advance_us(us);
+    return true;
+}
+
+void stdio_flush(void) { fflush(stdout); }
+
+int putchar_raw(int c) { return putchar(c); }
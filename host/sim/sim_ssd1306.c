@@ -0,0 +1,140 @@
+// Modelo do SSD1306 no barramento I2C do simulador
+//
+// Interpreta os mesmos bytes que o display recebe (byte de controle 0x00 =
+// comandos, 0x40 = dados), mantém a GDDRAM de 128x64 com endereçamento
+// horizontal e, a cada volta completa do ponteiro pela janela de coluna/página,
+// conta um quadro. Com SIM_FRAMES=dir cada quadro vira dir/frame_NNNNNN.pbm e
+// dir/last.pbm guarda sempre o mais recente (pixel aceso = preto no PBM).
+#include "hardware/i2c.h"
+#include "pico/time.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_WIDTH 128
+#define SIM_PAGES 8
+#define SIM_ADDR 0x3C
+
+struct i2c_inst {
+    int index;
+    unsigned baudrate;
+};
+
+static struct i2c_inst i2c_insts[2] = {{0, 100000}, {1, 100000}};
+i2c_inst_t* const i2c0 = &i2c_insts[0];
+i2c_inst_t* const i2c1 = &i2c_insts[1];
+
+static struct {
+    uint8_t ram[SIM_PAGES][SIM_WIDTH];
+    uint8_t cmd;        // comando esperando argumentos
+    uint8_t nargs;      // argumentos que faltam
+    uint8_t args[2];
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    bool on, inverted;
+    uint32_t frames;
+    const char* dir;
+} oled;
+
+void sim_display_init(void) {
+    memset(&oled, 0, sizeof(oled));
+    oled.col_end = SIM_WIDTH - 1;
+    oled.page_end = SIM_PAGES - 1;
+    oled.dir = getenv("SIM_FRAMES");
+}
+
+unsigned i2c_init(i2c_inst_t* i2c, unsigned baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+static void write_pbm(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    fprintf(f, "P4\n%d %d\n", SIM_WIDTH, SIM_PAGES * 8);
+    for (int y = 0; y < SIM_PAGES * 8; y++) {
+        for (int xb = 0; xb < SIM_WIDTH / 8; xb++) {
+            uint8_t packed = 0;
+            for (int b = 0; b < 8; b++) {
+                int x = xb * 8 + b;
+                bool lit = oled.on && (((oled.ram[y / 8][x] >> (y % 8)) & 1) != oled.inverted);
+                if (lit) packed |= (uint8_t)(0x80 >> b);
+            }
+            fputc(packed, f);
+        }
+    }
+    fclose(f);
+}
+
+// A0/A1 e C0/C8 só espelham a imagem no vidro; o driver já desenha pensando
+// em A1+C8, então a GDDRAM é despejada como está (x = coluna, y = página*8+bit)
+static void end_frame(void) {
+    oled.frames++;
+    if (!oled.dir) return;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%06u.pbm", oled.dir, (unsigned)oled.frames);
+    write_pbm(path);
+    snprintf(path, sizeof(path), "%s/last.pbm", oled.dir);
+    write_pbm(path);
+}
+
+static void data_byte(uint8_t v) {
+    oled.ram[oled.page % SIM_PAGES][oled.col % SIM_WIDTH] = v;
+    if (oled.col < oled.col_end) {
+        oled.col++;
+        return;
+    }
+    oled.col = oled.col_start;
+    if (oled.page < oled.page_end) {
+        oled.page++;
+        return;
+    }
+    oled.page = oled.page_start;
+    end_frame();  // voltou pro início da janela: quadro inteiro escrito
+}
+
+static uint8_t command_args(uint8_t c) {
+    switch (c) {
+        case 0x21: case 0x22: return 2;  // janela de coluna / página
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB: return 1;
+        default: return 0;
+    }
+}
+
+static void command_byte(uint8_t c) {
+    if (oled.nargs > 0) {
+        uint8_t n = command_args(oled.cmd);
+        if (oled.nargs <= n && n <= sizeof oled.args) oled.args[n - oled.nargs] = c;
+        if (--oled.nargs > 0) return;
+        if (oled.cmd == 0x21) {
+            oled.col_start = oled.col = oled.args[0] % SIM_WIDTH;
+            oled.col_end = oled.args[1] % SIM_WIDTH;
+        } else if (oled.cmd == 0x22) {
+            oled.page_start = oled.page = oled.args[0] % SIM_PAGES;
+            oled.page_end = oled.args[1] % SIM_PAGES;
+        }
+        return;
+    }
+    oled.nargs = command_args(c);
+    oled.cmd = c;
+    if (c == 0xAE) oled.on = false;
+    else if (c == 0xAF) oled.on = true;
+    else if (c == 0xA6) oled.inverted = false;
+    else if (c == 0xA7) oled.inverted = true;
+}
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    (void)nostop;
+    if (i2c != i2c1 || addr != SIM_ADDR || len == 0) return PICO_ERROR_GENERIC;  // ninguém responde o ACK
+    // ~9 bits por byte no barramento (endereço + dados)
+    sim_clock_advance_us((uint64_t)(len + 1) * 9 * 1000000 / i2c->baudrate);
+    bool data = (src[0] & 0x40) != 0;
+    for (size_t i = 1; i < len; i++) {
+        if (data) data_byte(src[i]);
+        else command_byte(src[i]);
+    }
+    return (int)len;
+}
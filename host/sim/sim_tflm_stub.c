@@ -0,0 +1,222 @@
+// TFLM de mentira pro simulador sem as fontes do tflite-micro (SIM_TFLM_DIR vazio)
+//
+// Mesma API (contextos inclusive) e mesma máquina de estados do tensor de entrada que
+// tflm_wrapper.cpp, com os tensores dentro da arena do mem_pool. A "predição" sai de um hash dos
+// pixels: determinística, mas sem relação com o dígito. Serve pra exercitar
+// protocolo, fila e display; pra acurácia de verdade compilar com o TFLM do host.
+// SIM_INVOKE_US (padrão 20000) é o custo de cada invoke: avança o relógio virtual,
+// ou dorme de verdade com SIM_CLOCK=real (aí os dois núcleos rodam em paralelo).
+// A escolha do modelo (partição da flash, depois embutido) é a mesma do wrapper,
+// mas a conferência do flatbuffer se limita ao identificador "TFL3".
+#include "tflm_wrapper.h"
+#include "mem_pool.h"
+#include "model_store.h"
+#include "pico/time.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include "mnist_cnn_int8_model_v1.h"
+
+#define IN_BYTES 784
+#define OUT_BYTES 10
+
+enum { INPUT_IDLE, INPUT_FILLING, INPUT_BUSY };
+
+// Contexto no começo da arena, tensores logo depois: [batch][784] e [batch][10]
+struct tflm_ctx {
+    int8_t* input;
+    int8_t* output;
+    int batch;
+    int input_state;
+};
+
+static tflm_ctx_t* instances[2] = {NULL, NULL};
+static uint64_t invoke_us = 20000;
+static const uint8_t* model_data = NULL;
+static uint32_t model_size = 0;
+static int model_slot = -1;
+
+static tflm_ctx_t* ctx_create(uint8_t* arena, int arena_size, int batch) {
+    const int header = (int)((sizeof(struct tflm_ctx) + 15) & ~(size_t)15);
+    if (!arena || arena_size < header + batch * (IN_BYTES + OUT_BYTES)) return NULL;
+    tflm_ctx_t* ctx = (tflm_ctx_t*)arena;
+    ctx->input = (int8_t*)arena + header;
+    ctx->output = ctx->input + batch * IN_BYTES;
+    ctx->batch = batch;
+    ctx->input_state = INPUT_IDLE;
+    return ctx;
+}
+
+tflm_ctx_t* tflm_ctx_create(const uint8_t* model, uint8_t* arena, int arena_size) {
+    if (tflm_model_check(model, 8) != 0) return NULL;
+    return ctx_create(arena, arena_size, 1);
+}
+
+void tflm_ctx_destroy(tflm_ctx_t* ctx) { (void)ctx; }
+
+tflm_ctx_t* tflm_ctx_default(void) { return instances[0]; }
+
+int tflm_init(void) {
+    uint8_t* arena = (uint8_t*)mem_pool_alloc(MEM_TENSOR_ARENA);
+    if (!arena) return 7;
+    instances[0] = ctx_create(arena, TFLM_ARENA_SIZE, CNN_BATCH);
+#if CNN_DUAL_CORE
+    uint8_t* arena1 = (uint8_t*)mem_pool_alloc(MEM_TENSOR_ARENA1);
+    if (!arena1) return 7;
+    instances[1] = ctx_create(arena1, TFLM_ARENA_SIZE, 1);
+#endif
+    model_slot = -1;
+    for (int rank = 0; rank < MODEL_STORE_SLOTS; rank++) {
+        int slot = model_store_get(rank, &model_data, &model_size);
+        if (slot < 0) break;
+        if (tflm_model_check(model_data, model_size) == 0) {
+            model_slot = slot;
+            break;
+        }
+        printf("Modelo do slot %d rejeitado: 1\n", slot);
+    }
+    if (model_slot < 0) {
+        model_data = mnist_cnn_int8_model;
+        model_size = sizeof(mnist_cnn_int8_model);
+    }
+    const char* us = getenv("SIM_INVOKE_US");
+    if (us) invoke_us = strtoull(us, NULL, 10);
+    return 0;
+}
+
+int8_t* tflm_ctx_input(tflm_ctx_t* ctx, int* nbytes) {
+    if (!ctx) return NULL;
+    if (nbytes) *nbytes = ctx->batch * IN_BYTES;
+    return ctx->input;
+}
+
+int8_t* tflm_ctx_output(tflm_ctx_t* ctx, int* nbytes) {
+    if (!ctx) return NULL;
+    if (nbytes) *nbytes = ctx->batch * OUT_BYTES;
+    return ctx->output;
+}
+
+// Mesma quantização do modelo exportado (entrada 0..1, saída do softmax)
+float tflm_ctx_input_scale(const tflm_ctx_t* ctx) { return ctx ? 1.0f / 255.0f : 0.0f; }
+int tflm_ctx_input_zero_point(const tflm_ctx_t* ctx) { return ctx ? -128 : 0; }
+float tflm_ctx_output_scale(const tflm_ctx_t* ctx) { return ctx ? 1.0f / 256.0f : 0.0f; }
+int tflm_ctx_output_zero_point(const tflm_ctx_t* ctx) { return ctx ? -128 : 0; }
+
+static void fake_slot(const int8_t* in, int8_t* out) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (int i = 0; i < IN_BYTES; i++) h = (h ^ (uint8_t)in[i]) * 16777619u;
+    for (int i = 0; i < OUT_BYTES; i++) out[i] = -128;
+    out[h % OUT_BYTES] = 127;
+}
+
+static int run_invoke(tflm_ctx_t* ctx, int n) {
+    for (int k = 0; k < n; k++) fake_slot(ctx->input + k * IN_BYTES, ctx->output + k * OUT_BYTES);
+    sleep_us(invoke_us);  // o custo é o do batch inteiro, como no device
+    return 0;
+}
+
+int tflm_ctx_invoke(tflm_ctx_t* ctx) {
+    if (!ctx) return 1;
+    if (ctx->input_state != INPUT_IDLE) return 3;
+    return run_invoke(ctx, ctx->batch);
+}
+
+int tflm_ctx_batch_size(const tflm_ctx_t* ctx) { return ctx ? ctx->batch : 0; }
+
+int tflm_ctx_arena_used_bytes(const tflm_ctx_t* ctx) {
+    return ctx ? ctx->batch * (IN_BYTES + OUT_BYTES) : -1;
+}
+
+int8_t* tflm_input_ptr(int* nbytes) { return tflm_ctx_input(instances[0], nbytes); }
+int8_t* tflm_output_ptr(int* nbytes) { return tflm_ctx_output(instances[0], nbytes); }
+float tflm_input_scale(void) { return tflm_ctx_input_scale(instances[0]); }
+int tflm_input_zero_point(void) { return tflm_ctx_input_zero_point(instances[0]); }
+float tflm_output_scale(void) { return tflm_ctx_output_scale(instances[0]); }
+int tflm_output_zero_point(void) { return tflm_ctx_output_zero_point(instances[0]); }
+
+int tflm_invoke(void) {
+    tflm_ctx_t* ctx = instances[0];
+    if (!ctx) return 1;
+    if (ctx->input_state != INPUT_IDLE) return 3;
+    return run_invoke(ctx, 1);
+}
+
+int8_t* tflm_input_acquire(void) {
+    tflm_ctx_t* ctx = instances[0];
+    if (!ctx || ctx->input_state != INPUT_IDLE) return NULL;
+    ctx->input_state = INPUT_FILLING;
+    return ctx->input;
+}
+
+void tflm_input_release(void) {
+    tflm_ctx_t* ctx = instances[0];
+    if (ctx && ctx->input_state == INPUT_FILLING) ctx->input_state = INPUT_IDLE;
+}
+
+int tflm_input_commit_invoke(void) {
+    tflm_ctx_t* ctx = instances[0];
+    if (!ctx) return 1;
+    if (ctx->input_state != INPUT_FILLING) return 3;
+    ctx->input_state = INPUT_BUSY;
+    int rc = run_invoke(ctx, 1);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+int tflm_batch_size(void) { return tflm_ctx_batch_size(instances[0]); }
+
+int tflm_invoke_batch(const int8_t* const* inputs, int8_t* const* outputs, int n) {
+    tflm_ctx_t* ctx = instances[0];
+    if (!ctx) return 1;
+    if (n < 1 || n > ctx->batch) return 4;
+    if (ctx->input_state == INPUT_BUSY) return 3;
+    if (ctx->input_state == INPUT_FILLING && inputs[0] != ctx->input) return 3;
+    ctx->input_state = INPUT_BUSY;
+    for (int k = 0; k < n; k++) {
+        if (inputs[k] != ctx->input + k * IN_BYTES) memcpy(ctx->input + k * IN_BYTES, inputs[k], IN_BYTES);
+    }
+    int rc = run_invoke(ctx, n);
+    for (int k = 0; k < n; k++) memcpy(outputs[k], ctx->output + k * OUT_BYTES, OUT_BYTES);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+int tflm_arena_used_bytes(void) { return tflm_ctx_arena_used_bytes(instances[0]); }
+
+int tflm_invoke_instance(int inst, const int8_t* in, int8_t* logits) {
+    if (inst < 0 || inst > 1 || !instances[inst]) return 1;
+    tflm_ctx_t* ctx = instances[inst];
+    bool in_place = (in == ctx->input);
+    if (ctx->input_state != (in_place ? INPUT_FILLING : INPUT_IDLE)) return 3;
+    ctx->input_state = INPUT_BUSY;
+    if (!in_place) memcpy(ctx->input, in, IN_BYTES);
+    int rc = run_invoke(ctx, 1);
+    if (rc == 0) memcpy(logits, ctx->output, OUT_BYTES);
+    ctx->input_state = INPUT_IDLE;
+    return rc;
+}
+
+int tflm_instance_arena_used_bytes(int inst) {
+    return inst >= 0 && inst <= 1 ? tflm_ctx_arena_used_bytes(instances[inst]) : -1;
+}
+
+int tflm_model_check(const uint8_t* data, uint32_t size) {
+    return (size >= 8 && memcmp(data + 4, "TFL3", 4) == 0) ? 0 : 1;
+}
+
+const uint8_t* tflm_model_data(uint32_t* size) {
+    if (size) *size = model_size;
+    return model_data;
+}
+
+int tflm_model_slot(void) { return model_slot; }
+
+// Sem convolução de verdade: só o fim do relatório
+void tflm_conv_command(const char* arg) {
+    while (*arg == ' ') arg++;
+    if (*arg == '\0') printf("CONV,END\n");
+    else printf("ERR,CONV\n");
+}
@@ -0,0 +1,834 @@
+#include "tflite_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ENGINE_X86 1
+#else
+#define ENGINE_X86 0
+#endif
+
+// ---------------------------------------------------------------------------
+// Leitura do flatbuffer (só o pedaço do schema do TFLite que o motor usa).
+// Todo acesso confere os limites do arquivo; um offset fora marca bad e devolve zero
+
+namespace {
+
+struct Fb {
+    const uint8_t* p = nullptr;
+    size_t n = 0;
+    bool bad = false;
+
+    template <typename T>
+    T rd(size_t off) {
+        T v{};
+        if (off > n || n - off < sizeof(T)) {
+            bad = true;
+            return v;
+        }
+        std::memcpy(&v, p + off, sizeof(T));
+        return v;
+    }
+    size_t ref(size_t off) {  // uoffset: relativo à própria posição
+        size_t t = off + rd<uint32_t>(off);
+        if (t >= n) {
+            bad = true;
+            return 0;
+        }
+        return t;
+    }
+};
+
+struct Vec;
+
+struct Table {
+    Fb* fb = nullptr;
+    size_t pos = 0;  // 0 = tabela ausente
+
+    size_t field(int i) const {
+        if (!pos) return 0;
+        int64_t vt = static_cast<int64_t>(pos) - fb->rd<int32_t>(pos);
+        if (vt < 0 || static_cast<size_t>(vt) >= fb->n) {
+            fb->bad = true;
+            return 0;
+        }
+        uint16_t vlen = fb->rd<uint16_t>(static_cast<size_t>(vt));
+        if (4 + 2 * i >= vlen) return 0;  // campo mais novo que o arquivo: default
+        uint16_t off = fb->rd<uint16_t>(static_cast<size_t>(vt) + 4 + 2 * i);
+        return off ? pos + off : 0;
+    }
+    template <typename T>
+    T get(int i, T def) const {
+        size_t f = field(i);
+        return f ? fb->rd<T>(f) : def;
+    }
+    Table table(int i) const {
+        size_t f = field(i);
+        return {fb, f ? fb->ref(f) : 0};
+    }
+    Vec vec(int i) const;
+};
+
+struct Vec {
+    Fb* fb = nullptr;
+    size_t pos = 0;  // primeiro elemento
+    uint32_t size = 0;
+
+    template <typename T>
+    T at(uint32_t k) const { return fb->rd<T>(pos + static_cast<size_t>(k) * sizeof(T)); }
+    Table table(uint32_t k) const { return {fb, fb->ref(pos + static_cast<size_t>(k) * 4)}; }
+};
+
+Vec Table::vec(int i) const {
+    size_t f = field(i);
+    if (!f) return {fb, 0, 0};
+    size_t v = fb->ref(f);
+    uint32_t n = fb->rd<uint32_t>(v);
+    if (n > fb->n) {  // nem com elementos de 1 byte caberia
+        fb->bad = true;
+        n = 0;
+    }
+    return {fb, v + 4, n};
+}
+
+// Campos das tabelas do schema (tensorflow/lite/schema/schema.fbs)
+enum { MODEL_VERSION = 0, MODEL_OPCODES = 1, MODEL_SUBGRAPHS = 2, MODEL_BUFFERS = 4 };
+enum { OPCODE_DEPRECATED = 0, OPCODE_BUILTIN = 3 };
+enum { SUBGRAPH_TENSORS = 0, SUBGRAPH_INPUTS = 1, SUBGRAPH_OUTPUTS = 2, SUBGRAPH_OPERATORS = 3 };
+enum { TENSOR_SHAPE = 0, TENSOR_TYPE = 1, TENSOR_BUFFER = 2, TENSOR_QUANT = 4 };
+enum { QUANT_SCALE = 2, QUANT_ZERO_POINT = 3 };
+enum { OP_OPCODE = 0, OP_INPUTS = 1, OP_OUTPUTS = 2, OP_OPTIONS = 4 };
+enum { BUFFER_DATA = 0 };
+
+enum { TYPE_INT32 = 2, TYPE_INT8 = 9 };
+enum { OP_CONV_2D = 3, OP_DEPTHWISE_CONV_2D = 4, OP_FULLY_CONNECTED = 9, OP_RESHAPE = 22, OP_SOFTMAX = 25,
+       OP_MEAN = 40 };
+enum { ACT_NONE = 0, ACT_RELU = 1, ACT_RELU_N1_TO_1 = 2, ACT_RELU6 = 3 };
+enum { PADDING_SAME = 0, PADDING_VALID = 1 };
+
+// ---------------------------------------------------------------------------
+// Aritmética de ponto fixo do TFLite/gemmlowp (sem TFLITE_SINGLE_ROUNDING), igual à do TFLM
+
+int32_t srdhm(int32_t a, int32_t b) {  // SaturatingRoundingDoublingHighMul
+    if (a == b && a == std::numeric_limits<int32_t>::min()) return std::numeric_limits<int32_t>::max();
+    int64_t ab = static_cast<int64_t>(a) * b;
+    int64_t nudge = ab >= 0 ? (1 << 30) : (1 - (1 << 30));
+    return static_cast<int32_t>((ab + nudge) / (int64_t(1) << 31));
+}
+
+int32_t rdpot(int32_t x, int exponent) {  // RoundingDivideByPOT
+    int32_t mask = static_cast<int32_t>((int64_t(1) << exponent) - 1);
+    int32_t remainder = x & mask;
+    int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+    return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+int32_t mbqm(int32_t x, int32_t mult, int shift) {  // MultiplyByQuantizedMultiplier
+    int left = shift > 0 ? shift : 0;
+    int right = shift > 0 ? 0 : -shift;
+    return rdpot(srdhm(static_cast<int32_t>(static_cast<uint32_t>(x) << left), mult), right);
+}
+
+// Saturating left shift do gemmlowp (SaturatingRoundingMultiplyByPOT com expoente > 0)
+int32_t sat_shl(int32_t x, int exponent) {
+    const int32_t threshold = (1 << (31 - exponent)) - 1;
+    if (x > threshold) return std::numeric_limits<int32_t>::max();
+    if (x < -threshold) return std::numeric_limits<int32_t>::min();
+    return static_cast<int32_t>(static_cast<uint32_t>(x) << exponent);
+}
+
+void quantize_multiplier(double m, int32_t* mult, int* shift) {  // QuantizeMultiplier
+    if (m == 0.0) {
+        *mult = 0;
+        *shift = 0;
+        return;
+    }
+    const double q = std::frexp(m, shift);
+    int64_t q_fixed = static_cast<int64_t>(std::round(q * (int64_t(1) << 31)));
+    if (q_fixed == (int64_t(1) << 31)) {
+        q_fixed /= 2;
+        ++*shift;
+    }
+    if (*shift < -31) {
+        *shift = 0;
+        q_fixed = 0;
+    }
+    *mult = static_cast<int32_t>(q_fixed);
+}
+
+// exp(a) pra a <= 0 em ponto fixo: entrada com 5 bits inteiros, saída com 0 (gemmlowp)
+int32_t exp_on_interval_between_negative_one_quarter_and_0_excl(int32_t a) {
+    const int32_t constant_term = 1895147668;
+    const int32_t constant_1_over_3 = 715827883;
+    int32_t x = a + (1 << 28);  // a + 1/8
+    int32_t x2 = srdhm(x, x);
+    int32_t x3 = srdhm(x2, x);
+    int32_t x4 = srdhm(x2, x2);
+    int32_t x4_over_4 = rdpot(x4, 2);
+    int32_t poly = rdpot(srdhm(x4_over_4 + x3, constant_1_over_3) + x2, 1);
+    return constant_term + srdhm(constant_term, x + poly);
+}
+
+int32_t exp_on_negative_values(int32_t a) {
+    const int kFractionalBits = 26;
+    const int32_t one_quarter = 1 << (kFractionalBits - 2);
+    const int32_t mask = one_quarter - 1;
+    const int32_t a_mod_quarter_minus_one_quarter = (a & mask) - one_quarter;
+    int32_t result = exp_on_interval_between_negative_one_quarter_and_0_excl(sat_shl(a_mod_quarter_minus_one_quarter, 5));
+    const int32_t remainder = a_mod_quarter_minus_one_quarter - a;
+    static const int32_t multipliers[7] = {1672461947, 1302514674, 790015084, 290630308, 39332535, 720401, 242};
+    for (int e = -2; e <= 4; e++) {
+        if (remainder & (1 << (kFractionalBits + e))) result = srdhm(result, multipliers[e + 2]);
+    }
+    return a == 0 ? std::numeric_limits<int32_t>::max() : result;
+}
+
+int32_t one_over_one_plus_x_for_x_in_0_1(int32_t a) {
+    // RoundingHalfSum(a, One) com One = INT32_MAX (0 bits inteiros)
+    int64_t sum = static_cast<int64_t>(a) + std::numeric_limits<int32_t>::max();
+    const int32_t half_denominator = static_cast<int32_t>((sum + (sum >= 0 ? 1 : -1)) / 2);
+    const int32_t constant_48_over_17 = 1515870810;
+    const int32_t constant_neg_32_over_17 = -1010580540;
+    int32_t x = constant_48_over_17 + srdhm(half_denominator, constant_neg_32_over_17);
+    for (int i = 0; i < 3; i++) {
+        int32_t half_denominator_times_x = srdhm(half_denominator, x);
+        int32_t one_minus = (1 << 29) - half_denominator_times_x;  // F2::One() - ...
+        x = x + sat_shl(srdhm(x, one_minus), 2);
+    }
+    return sat_shl(x, 1);  // Rescale<0>(ExactMulByPot<-1>(x))
+}
+
+int count_leading_zeros(uint32_t x) {
+    return x ? __builtin_clz(x) : 32;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+
+struct TfliteEngine::Tensor {
+    std::vector<int> shape;
+    int type = 0;
+    const uint8_t* data = nullptr;  // constante (buffer dentro do arquivo), ou nullptr
+    size_t bytes = 0;
+    std::vector<float> scale;
+    std::vector<int64_t> zero_point;
+
+    size_t elements() const {
+        size_t n = 1;
+        for (int d : shape) n *= static_cast<size_t>(std::max(d, 0));
+        return n;
+    }
+    int dim(int i) const { return i < static_cast<int>(shape.size()) ? shape[i] : 1; }
+    float s() const { return scale.empty() ? 0.0f : scale[0]; }
+    int32_t zp() const { return zero_point.empty() ? 0 : static_cast<int32_t>(zero_point[0]); }
+};
+
+struct TfliteEngine::Op {
+    int code = 0;
+    std::vector<int> in, out;
+    // Convoluções e densa
+    int in_h = 1, in_w = 1, in_c = 1, out_h = 1, out_w = 1, out_c = 1;
+    int k_h = 1, k_w = 1, stride_h = 1, stride_w = 1, dil_h = 1, dil_w = 1, pad_h = 0, pad_w = 0, depth_mult = 1;
+    int32_t in_zp = 0, out_zp = 0, act_min = -128, act_max = 127;
+    int k = 0;                     // taps por saída (k_h*k_w*in_c); na densa, o tamanho da entrada
+    int padded_h = 0, padded_w = 0;  // CONV_2D: entrada em int16 com o padding (zero point) em volta
+    std::vector<int8_t> filter;    // [out_c][k] (depthwise: [k_h][k_w][out_c], como no arquivo)
+    std::vector<int32_t> bias;     // conv/densa: já com o zero point da entrada; depthwise: o original
+    std::vector<int32_t> mult, shift;
+    // AVX2: pesos em pares int16 [k/2][oc_pad] e multiplicadores completados até oc_pad
+    int oc_pad = 0;
+    std::vector<int32_t> packed;
+    std::vector<int32_t> mult_pad, shift_pad, bias_pad;
+    // SOFTMAX
+    int32_t sm_mult = 0;
+    int sm_shift = 0;
+    int32_t diff_min = 0;
+    // MEAN
+    int mean_n = 0;
+    bool mean_plain = false;
+    float mean_scale = 0.0f, mean_bias = 0.0f;
+};
+
+TfliteEngine::TfliteEngine() {
+#if ENGINE_X86
+    avx2_ = __builtin_cpu_supports("avx2");
+#endif
+    vector_ = avx2_;
+}
+
+TfliteEngine::~TfliteEngine() = default;
+
+bool TfliteEngine::fail(const std::string& msg) {
+    error_ = msg;
+    return false;
+}
+
+bool TfliteEngine::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return fail("não abriu " + path);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return load(data.data(), data.size());
+}
+
+bool TfliteEngine::load(const uint8_t* data, size_t size) {
+    file_.assign(data, data + size);
+    tensors_.clear();
+    ops_.clear();
+    if (size < 8 || std::memcmp(file_.data() + 4, "TFL3", 4) != 0) return fail("não é um .tflite (TFL3)");
+    Fb fb{file_.data(), file_.size()};
+    Table model{&fb, fb.ref(0)};
+    if (model.get<uint32_t>(MODEL_VERSION, 0) != 3) return fail("versão do schema diferente de 3");
+
+    Vec opcodes = model.vec(MODEL_OPCODES);
+    std::vector<int> codes;
+    for (uint32_t i = 0; i < opcodes.size; i++) {
+        Table oc = opcodes.table(i);
+        // builtin_code novo (int32) ou o antigo (int8, até 127): vale o maior
+        codes.push_back(std::max<int>(oc.get<int8_t>(OPCODE_DEPRECATED, 0), oc.get<int32_t>(OPCODE_BUILTIN, 0)));
+    }
+    Vec buffers = model.vec(MODEL_BUFFERS);
+    Vec subgraphs = model.vec(MODEL_SUBGRAPHS);
+    if (subgraphs.size != 1) return fail("esperava um subgrafo só");
+    Table sg = subgraphs.table(0);
+
+    Vec tv = sg.vec(SUBGRAPH_TENSORS);
+    for (uint32_t i = 0; i < tv.size; i++) {
+        Table t = tv.table(i);
+        Tensor ten;
+        Vec shape = t.vec(TENSOR_SHAPE);
+        for (uint32_t d = 0; d < shape.size; d++) ten.shape.push_back(shape.at<int32_t>(d));
+        ten.type = t.get<int8_t>(TENSOR_TYPE, 0);
+        uint32_t buf = t.get<uint32_t>(TENSOR_BUFFER, 0);
+        if (buf < buffers.size) {
+            Vec bd = buffers.table(buf).vec(BUFFER_DATA);
+            if (bd.size && bd.pos + bd.size <= fb.n) {
+                ten.data = file_.data() + bd.pos;
+                ten.bytes = bd.size;
+            }
+        }
+        Table q = t.table(TENSOR_QUANT);
+        Vec sc = q.vec(QUANT_SCALE), zp = q.vec(QUANT_ZERO_POINT);
+        for (uint32_t k = 0; k < sc.size; k++) ten.scale.push_back(sc.at<float>(k));
+        for (uint32_t k = 0; k < zp.size; k++) ten.zero_point.push_back(zp.at<int64_t>(k));
+        tensors_.push_back(ten);
+    }
+
+    Vec ins = sg.vec(SUBGRAPH_INPUTS), outs = sg.vec(SUBGRAPH_OUTPUTS);
+    if (ins.size != 1 || outs.size != 1) return fail("esperava uma entrada e uma saída");
+    input_ = ins.at<int32_t>(0);
+    output_ = outs.at<int32_t>(0);
+
+    Vec ov = sg.vec(SUBGRAPH_OPERATORS);
+    for (uint32_t i = 0; i < ov.size; i++) {
+        Table o = ov.table(i);
+        Op op;
+        uint32_t idx = o.get<uint32_t>(OP_OPCODE, 0);
+        if (idx >= codes.size()) return fail("opcode fora da tabela");
+        op.code = codes[idx];
+        Vec vi = o.vec(OP_INPUTS), vo = o.vec(OP_OUTPUTS);
+        for (uint32_t k = 0; k < vi.size; k++) op.in.push_back(vi.at<int32_t>(k));
+        for (uint32_t k = 0; k < vo.size; k++) op.out.push_back(vo.at<int32_t>(k));
+        Table opt = o.table(OP_OPTIONS);
+        switch (op.code) {
+        case OP_CONV_2D:  // Conv2DOptions: padding, stride_w, stride_h, ativação, dilation_w, dilation_h
+            op.pad_h = opt.get<int8_t>(0, PADDING_SAME);  // guardado aqui até o prepare
+            op.stride_w = opt.get<int32_t>(1, 1);
+            op.stride_h = opt.get<int32_t>(2, 1);
+            op.act_min = opt.get<int8_t>(3, ACT_NONE);
+            op.dil_w = opt.get<int32_t>(4, 1);
+            op.dil_h = opt.get<int32_t>(5, 1);
+            break;
+        case OP_DEPTHWISE_CONV_2D:  // + depth_multiplier antes da ativação
+            op.pad_h = opt.get<int8_t>(0, PADDING_SAME);
+            op.stride_w = opt.get<int32_t>(1, 1);
+            op.stride_h = opt.get<int32_t>(2, 1);
+            op.depth_mult = opt.get<int32_t>(3, 1);
+            op.act_min = opt.get<int8_t>(4, ACT_NONE);
+            op.dil_w = opt.get<int32_t>(5, 1);
+            op.dil_h = opt.get<int32_t>(6, 1);
+            break;
+        case OP_FULLY_CONNECTED:  // FullyConnectedOptions: ativação, formato dos pesos
+            op.act_min = opt.get<int8_t>(0, ACT_NONE);
+            if (opt.get<int8_t>(1, 0) != 0) return fail("FULLY_CONNECTED com pesos embaralhados");
+            break;
+        case OP_MEAN:  // ReducerOptions: keep_dims
+            op.mean_n = opt.get<uint8_t>(0, 0);
+            break;
+        case OP_SOFTMAX: {  // SoftmaxOptions: beta
+            float beta = opt.get<float>(0, 0.0f);
+            std::memcpy(&op.sm_mult, &beta, sizeof(beta));  // guardado aqui até o prepare
+            break;
+        }
+        case OP_RESHAPE:
+            break;
+        default:
+            return fail("op não suportada: builtin " + std::to_string(op.code));
+        }
+        ops_.push_back(op);
+    }
+    if (fb.bad) return fail("flatbuffer corrompido (offset fora do arquivo)");
+    return prepare();
+}
+
+// Faixa da ativação fundida já quantizada (CalculateActivationRangeQuantized)
+static void activation_range(int act, float scale, int32_t zp, int32_t* lo, int32_t* hi) {
+    auto quantize = [&](float f) { return zp + static_cast<int32_t>(std::round(f / scale)); };
+    *lo = -128;
+    *hi = 127;
+    if (act == ACT_RELU || act == ACT_RELU6) *lo = std::max(*lo, quantize(0.0f));
+    if (act == ACT_RELU6) *hi = std::min(*hi, quantize(6.0f));
+    if (act == ACT_RELU_N1_TO_1) {
+        *lo = std::max(*lo, quantize(-1.0f));
+        *hi = std::min(*hi, quantize(1.0f));
+    }
+}
+
+// Padding do TFLite: deslocamento do começo (o que sobra fica no fim)
+static int padding_offset(int padding, int in, int k, int stride, int dil, int* out) {
+    const int ek = (k - 1) * dil + 1;
+    *out = padding == PADDING_SAME ? (in + stride - 1) / stride : (in - ek + stride) / stride;
+    if (padding != PADDING_SAME) return 0;
+    return std::max((*out - 1) * stride + ek - in, 0) / 2;
+}
+
+bool TfliteEngine::prepare() {
+    const int nt = static_cast<int>(tensors_.size());
+    auto valid = [&](int t) { return t >= 0 && t < nt; };
+    if (!valid(input_) || !valid(output_)) return fail("entrada/saída inválida");
+    if (tensors_[input_].type != TYPE_INT8 || tensors_[output_].type != TYPE_INT8) return fail("entrada/saída não é int8");
+    if (tensors_[input_].dim(0) != 1) return fail("só modelo com batch 1");
+
+    for (Op& op : ops_) {
+        for (int t : op.in) {
+            if (t >= 0 && !valid(t)) return fail("tensor fora da tabela");
+        }
+        if (op.out.size() != 1 || !valid(op.out[0]) || op.in.empty() || !valid(op.in[0])) return fail("op sem entrada/saída");
+        const Tensor& in = tensors_[op.in[0]];
+        const Tensor& out = tensors_[op.out[0]];
+        if (in.type != TYPE_INT8 || out.type != TYPE_INT8) return fail("op com entrada ou saída que não é int8");
+        op.in_zp = in.zp();
+        op.out_zp = out.zp();
+
+        if (op.code == OP_CONV_2D || op.code == OP_DEPTHWISE_CONV_2D || op.code == OP_FULLY_CONNECTED) {
+            if (op.in.size() < 2 || !valid(op.in[1])) return fail("op sem pesos");
+            const Tensor& w = tensors_[op.in[1]];
+            const Tensor* b = op.in.size() > 2 && valid(op.in[2]) ? &tensors_[op.in[2]] : nullptr;
+            if (w.type != TYPE_INT8 || !w.data || w.bytes < w.elements()) return fail("pesos não são int8 constantes");
+            for (int64_t z : w.zero_point) {
+                if (z != 0) return fail("pesos com zero point diferente de 0");
+            }
+            if (b && (b->type != TYPE_INT32 || !b->data || b->bytes < b->elements() * 4)) return fail("bias não é int32 constante");
+            int act = op.act_min;
+            activation_range(act, out.s(), op.out_zp, &op.act_min, &op.act_max);
+
+            if (op.code == OP_FULLY_CONNECTED) {
+                op.k = w.dim(1);
+                op.out_c = w.dim(0);
+                if (w.shape.size() != 2 || op.k <= 0 || in.elements() != static_cast<size_t>(op.k)) return fail("FULLY_CONNECTED com formato não suportado");
+            } else {
+                if (in.shape.size() != 4 || w.shape.size() != 4 || out.shape.size() != 4) return fail("conv sem formato NHWC");
+                op.in_h = in.dim(1);
+                op.in_w = in.dim(2);
+                op.in_c = in.dim(3);
+                op.k_h = w.dim(1);
+                op.k_w = w.dim(2);
+                int padding = op.pad_h;
+                op.pad_h = padding_offset(padding, op.in_h, op.k_h, op.stride_h, op.dil_h, &op.out_h);
+                op.pad_w = padding_offset(padding, op.in_w, op.k_w, op.stride_w, op.dil_w, &op.out_w);
+                op.out_c = out.dim(3);
+                if (op.out_h != out.dim(1) || op.out_w != out.dim(2)) return fail("conv com saída de formato inesperado");
+                if (op.code == OP_CONV_2D) {
+                    if (w.dim(3) != op.in_c || w.dim(0) != op.out_c) return fail("CONV_2D com grupos não suportada");
+                    op.k = op.k_h * op.k_w * op.in_c;
+                    // Entrada com a borda de padding já preenchida, cobrindo todas as janelas
+                    op.padded_h = std::max((op.out_h - 1) * op.stride_h + (op.k_h - 1) * op.dil_h + 1, op.in_h + op.pad_h);
+                    op.padded_w = std::max((op.out_w - 1) * op.stride_w + (op.k_w - 1) * op.dil_w + 1, op.in_w + op.pad_w);
+                } else {
+                    if (w.dim(0) != 1 || w.dim(3) != op.out_c || op.out_c != op.in_c * op.depth_mult) return fail("DEPTHWISE_CONV_2D com formato não suportado");
+                    op.k = op.k_h * op.k_w;
+                }
+            }
+            op.filter.assign(reinterpret_cast<const int8_t*>(w.data), reinterpret_cast<const int8_t*>(w.data) + w.elements());
+            op.bias.assign(static_cast<size_t>(op.out_c), 0);
+            if (b) std::memcpy(op.bias.data(), b->data, static_cast<size_t>(op.out_c) * 4);
+
+            // Multiplicadores por canal (PopulateConvolutionQuantizationParams); a densa por
+            // tensor usa o produto de scales em float, como GetQuantizedConvolutionMultipler
+            const bool per_channel = w.scale.size() > 1;
+            if (per_channel && w.scale.size() != static_cast<size_t>(op.out_c)) return fail("scales por canal não batem com os canais");
+            op.mult.resize(static_cast<size_t>(op.out_c));
+            op.shift.resize(static_cast<size_t>(op.out_c));
+            for (int c = 0; c < op.out_c; c++) {
+                double eff;
+                if (op.code == OP_FULLY_CONNECTED && !per_channel) {
+                    eff = static_cast<double>(in.s() * w.s()) / static_cast<double>(out.s());
+                } else {
+                    eff = static_cast<double>(in.s()) * static_cast<double>(w.scale[per_channel ? c : 0]) / static_cast<double>(out.s());
+                }
+                int sh;
+                quantize_multiplier(eff, &op.mult[c], &sh);
+                op.shift[c] = sh;
+            }
+            if (op.code == OP_DEPTHWISE_CONV_2D) continue;
+
+            // Zero point da entrada no bias: sum(w*(x - zp)) = sum(w*x) - zp*sum(w). O
+            // padding entra na janela como zp, que contribui zero, igual a pular o tap
+            for (int c = 0; c < op.out_c; c++) {
+                int32_t sum = 0;
+                for (int i = 0; i < op.k; i++) sum += op.filter[static_cast<size_t>(c) * op.k + i];
+                op.bias[c] -= op.in_zp * sum;
+            }
+            op.oc_pad = (op.out_c + 7) / 8 * 8;
+            const int pairs = (op.k + 1) / 2;
+            op.packed.assign(static_cast<size_t>(pairs) * op.oc_pad, 0);
+            for (int p = 0; p < pairs; p++) {
+                for (int c = 0; c < op.out_c; c++) {
+                    const int8_t* wc = op.filter.data() + static_cast<size_t>(c) * op.k;
+                    uint16_t lo = static_cast<uint16_t>(static_cast<int16_t>(wc[2 * p]));
+                    uint16_t hi = 2 * p + 1 < op.k ? static_cast<uint16_t>(static_cast<int16_t>(wc[2 * p + 1])) : 0;
+                    op.packed[static_cast<size_t>(p) * op.oc_pad + c] = static_cast<int32_t>(lo | static_cast<uint32_t>(hi) << 16);
+                }
+            }
+            op.mult_pad = op.mult;
+            op.shift_pad = op.shift;
+            op.bias_pad = op.bias;
+            op.mult_pad.resize(static_cast<size_t>(op.oc_pad), 0);
+            op.shift_pad.resize(static_cast<size_t>(op.oc_pad), 0);
+            op.bias_pad.resize(static_cast<size_t>(op.oc_pad), 0);
+        } else if (op.code == OP_MEAN) {
+            // Só a média espacial de uma entrada NHWC (GlobalAveragePooling2D), sem keep_dims
+            if (op.mean_n) return fail("MEAN com keep_dims não suportado");
+            if (op.in.size() < 2 || !valid(op.in[1])) return fail("MEAN sem eixos");
+            const Tensor& axis = tensors_[op.in[1]];
+            if (axis.type != TYPE_INT32 || !axis.data || axis.elements() != 2 || in.shape.size() != 4) return fail("MEAN com formato não suportado");
+            int32_t ax[2];
+            std::memcpy(ax, axis.data, sizeof(ax));
+            if (!((ax[0] == 1 && ax[1] == 2) || (ax[0] == 2 && ax[1] == 1))) return fail("MEAN só nos eixos 1 e 2");
+            op.in_h = in.dim(1);
+            op.in_w = in.dim(2);
+            op.in_c = in.dim(3);
+            op.mean_n = op.in_h * op.in_w;
+            // Mesma quantização dos dois lados: média inteira (reference_ops::Mean); senão
+            // a conta em float do QuantizedMeanOrSum, na mesma ordem, que é o que decide o arredondamento
+            op.mean_plain = in.zp() == out.zp() && in.s() == out.s();
+            op.mean_scale = in.s() / out.s();
+            op.mean_bias = -op.in_zp * op.mean_scale;
+        } else if (op.code == OP_SOFTMAX) {
+            float beta;
+            std::memcpy(&beta, &op.sm_mult, sizeof(beta));
+            if (out.s() != 1.0f / 256 || op.out_zp != -128) return fail("SOFTMAX int8 com saída fora de 1/256, -128");
+            // PreprocessSoftmaxScaling com 5 bits inteiros na diferença
+            const double max_real = (int64_t(1) << 31) - 1.0;
+            double real = std::min(static_cast<double>(beta) * static_cast<double>(in.s()) * (1 << (31 - 5)), max_real);
+            quantize_multiplier(real, &op.sm_mult, &op.sm_shift);
+            if (op.sm_shift < 0) return fail("SOFTMAX com beta*scale pequeno demais");
+            // CalculateInputRadius(5, shift)
+            const double radius = 1.0 * ((1 << 5) - 1) * (int64_t(1) << (31 - 5)) / (int64_t(1) << op.sm_shift);
+            op.diff_min = -static_cast<int32_t>(std::floor(radius));
+            op.in_c = in.shape.empty() ? 1 : in.shape.back();
+        } else if (op.code == OP_RESHAPE) {
+            if (in.elements() != out.elements() || in.zp() != out.zp() || in.s() != out.s()) return fail("RESHAPE com quantização diferente");
+        }
+    }
+    return true;
+}
+
+int TfliteEngine::input_bytes() const { return static_cast<int>(tensors_[input_].elements()); }
+int TfliteEngine::output_bytes() const { return static_cast<int>(tensors_[output_].elements()); }
+float TfliteEngine::input_scale() const { return tensors_[input_].s(); }
+int TfliteEngine::input_zero_point() const { return tensors_[input_].zp(); }
+float TfliteEngine::output_scale() const { return tensors_[output_].s(); }
+int TfliteEngine::output_zero_point() const { return tensors_[output_].zp(); }
+
+std::unique_ptr<TfliteEngine::Workspace> TfliteEngine::make_workspace() const {
+    auto ws = std::make_unique<Workspace>();
+    ws->t.resize(tensors_.size());
+    size_t win = 2, acc = 8, padded = 0;
+    for (const Op& op : ops_) {
+        ws->t[op.out[0]].resize(tensors_[op.out[0]].elements());
+        win = std::max(win, static_cast<size_t>(op.k + 1));
+        acc = std::max(acc, static_cast<size_t>(op.oc_pad));
+        padded = std::max(padded, static_cast<size_t>(op.padded_h) * op.padded_w * op.in_c);
+    }
+    ws->window.resize(win);
+    ws->padded.resize(padded);
+    ws->acc.resize(acc);
+    return ws;
+}
+
+// ---------------------------------------------------------------------------
+// Kernels. Conv e densa são o mesmo produto: janela int16[k] (já com o padding) contra
+// os pesos de cada canal, começando do bias com o zero point; muda só a requantização
+
+namespace {
+
+using Op = TfliteEngine::Op;
+
+void gemv_scalar(const Op& op, const int16_t* x, int32_t* acc) {
+    for (int c = 0; c < op.out_c; c++) {
+        const int8_t* w = op.filter.data() + static_cast<size_t>(c) * op.k;
+        int32_t a = op.bias[c];
+        for (int i = 0; i < op.k; i++) a += w[i] * x[i];
+        acc[c] = a;
+    }
+}
+
+void requant_scalar(const Op& op, const int32_t* acc, int8_t* out) {
+    for (int c = 0; c < op.out_c; c++) {
+        int32_t v = mbqm(acc[c], op.mult[c], op.shift[c]) + op.out_zp;
+        out[c] = static_cast<int8_t>(std::min(op.act_max, std::max(op.act_min, v)));
+    }
+}
+
+#if ENGINE_X86
+// NB blocos de 8 canais a partir de acc/w; cada passo soma 2 taps por canal (madd)
+template <int NB>
+__attribute__((target("avx2"))) void gemv_avx2_blocks(const int32_t* w, int stride, const int16_t* x, int pairs,
+                                                      int32_t* acc) {
+    __m256i a[NB];
+    for (int b = 0; b < NB; b++) a[b] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 8 * b));
+    for (int p = 0; p < pairs; p++, w += stride) {
+        int32_t xp;
+        std::memcpy(&xp, x + 2 * p, sizeof(xp));
+        const __m256i xv = _mm256_set1_epi32(xp);
+        for (int b = 0; b < NB; b++) {
+            const __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + 8 * b));
+            a[b] = _mm256_add_epi32(a[b], _mm256_madd_epi16(xv, wv));
+        }
+    }
+    for (int b = 0; b < NB; b++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 8 * b), a[b]);
+}
+
+__attribute__((target("avx2"))) void gemv_avx2(const Op& op, int16_t* x, int32_t* acc) {
+    if (op.k & 1) x[op.k] = 0;  // par incompleto: o peso dele é zero, a entrada também tem que ser finita
+    std::memcpy(acc, op.bias_pad.data(), static_cast<size_t>(op.oc_pad) * 4);
+    const int pairs = (op.k + 1) / 2;
+    int b = 0;
+    const int nb = op.oc_pad / 8;
+    for (; b + 4 <= nb; b += 4) gemv_avx2_blocks<4>(op.packed.data() + 8 * b, op.oc_pad, x, pairs, acc + 8 * b);
+    for (; b + 2 <= nb; b += 2) gemv_avx2_blocks<2>(op.packed.data() + 8 * b, op.oc_pad, x, pairs, acc + 8 * b);
+    for (; b < nb; b++) gemv_avx2_blocks<1>(op.packed.data() + 8 * b, op.oc_pad, x, pairs, acc + 8 * b);
+}
+
+// srdhm em 8 lanes (b >= 0: os multiplicadores do QuantizeMultiplier nunca são negativos)
+__attribute__((target("avx2"))) __m256i srdhm_avx2(__m256i a, __m256i b) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i nudge_pos = _mm256_set1_epi64x(1 << 30);
+    const __m256i nudge_neg = _mm256_set1_epi64x(1 - (1 << 30));
+    const __m256i low31 = _mm256_set1_epi64x(0x7FFFFFFF);
+    const __m256i one = _mm256_set1_epi64x(1);
+    __m256i q[2];
+    for (int h = 0; h < 2; h++) {
+        // h = 0: lanes pares (mul_epi32 usa os 32 bits de baixo de cada 64); h = 1: ímpares
+        const __m256i aa = h ? _mm256_srli_epi64(a, 32) : a;
+        const __m256i bb = h ? _mm256_srli_epi64(b, 32) : b;
+        __m256i p = _mm256_mul_epi32(aa, bb);
+        p = _mm256_add_epi64(p, _mm256_blendv_epi8(nudge_pos, nudge_neg, _mm256_cmpgt_epi64(zero, p)));
+        // divisão por 2^31 truncando pra zero: shift (arredonda pra baixo) + 1 se negativo com resto
+        __m256i fl = _mm256_srli_epi64(p, 31);  // os 32 bits de baixo já são o piso
+        __m256i rem = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_and_si256(p, low31), zero), _mm256_cmpgt_epi64(zero, p));
+        q[h] = _mm256_add_epi64(fl, _mm256_and_si256(rem, one));
+    }
+    __m256i r = _mm256_blend_epi32(q[0], _mm256_slli_epi64(q[1], 32), 0xAA);
+    // a == b == INT32_MIN não acontece com b >= 0
+    return r;
+}
+
+__attribute__((target("avx2"))) void requant_avx2(const Op& op, const int32_t* acc, int8_t* out) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zp = _mm256_set1_epi32(op.out_zp);
+    const __m256i lo = _mm256_set1_epi32(op.act_min);
+    const __m256i hi = _mm256_set1_epi32(op.act_max);
+    alignas(32) int32_t tmp[8];
+    for (int c = 0; c < op.out_c; c += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + c));
+        const __m256i shift = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(op.shift_pad.data() + c));
+        const __m256i mult = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(op.mult_pad.data() + c));
+        const __m256i left = _mm256_max_epi32(shift, zero);
+        const __m256i right = _mm256_max_epi32(_mm256_sub_epi32(zero, shift), zero);
+        x = srdhm_avx2(_mm256_sllv_epi32(x, left), mult);
+        // RoundingDivideByPOT com expoente por lane
+        const __m256i mask = _mm256_sub_epi32(_mm256_sllv_epi32(one, right), one);
+        const __m256i rem = _mm256_and_si256(x, mask);
+        const __m256i thr = _mm256_sub_epi32(_mm256_srli_epi32(mask, 1), _mm256_cmpgt_epi32(zero, x));
+        x = _mm256_sub_epi32(_mm256_srav_epi32(x, right), _mm256_cmpgt_epi32(rem, thr));
+        x = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(x, zp), lo), hi);
+        if (c + 8 <= op.out_c) {  // já está na faixa do int8: os packs não saturam
+            const __m128i w16 = _mm_packs_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + c), _mm_packs_epi16(w16, w16));
+            continue;
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(tmp), x);
+        const int n = op.out_c - c;
+        for (int i = 0; i < n; i++) out[c + i] = static_cast<int8_t>(tmp[i]);
+    }
+}
+#endif
+
+// Entrada da conv em int16 com a moldura de padding no zero point: cada pixel é
+// convertido uma vez, não uma vez por janela que passa por ele
+void pad_input(const Op& op, const int8_t* in, int16_t* padded) {
+    const size_t row = static_cast<size_t>(op.padded_w) * op.in_c;
+    std::fill(padded, padded + row * op.padded_h, static_cast<int16_t>(op.in_zp));
+    for (int y = 0; y < op.in_h; y++) {
+        int16_t* dst = padded + (y + op.pad_h) * row + static_cast<size_t>(op.pad_w) * op.in_c;
+        const int8_t* src = in + static_cast<size_t>(y) * op.in_w * op.in_c;
+        for (int i = 0; i < op.in_w * op.in_c; i++) dst[i] = src[i];
+    }
+}
+
+// Janela da saída (oy, ox), tap a tap na ordem do filtro [k_h][k_w][in_c]
+void gather_window(const Op& op, const int16_t* padded, int oy, int ox, int16_t* x) {
+    const size_t row = static_cast<size_t>(op.padded_w) * op.in_c;
+    const int16_t* src = padded + static_cast<size_t>(oy) * op.stride_h * row + static_cast<size_t>(ox) * op.stride_w * op.in_c;
+    for (int fy = 0; fy < op.k_h; fy++, src += op.dil_h * row) {
+        if (op.dil_w == 1) {
+            std::memcpy(x, src, static_cast<size_t>(op.k_w) * op.in_c * sizeof(int16_t));
+            x += op.k_w * op.in_c;
+            continue;
+        }
+        for (int fx = 0; fx < op.k_w; fx++, x += op.in_c) {
+            std::memcpy(x, src + static_cast<size_t>(fx) * op.dil_w * op.in_c, static_cast<size_t>(op.in_c) * sizeof(int16_t));
+        }
+    }
+}
+
+// reference_integer_ops::DepthwiseConvPerChannel
+void depthwise(const Op& op, const int8_t* in, int8_t* out) {
+    for (int oy = 0; oy < op.out_h; oy++) {
+        for (int ox = 0; ox < op.out_w; ox++) {
+            const int y0 = oy * op.stride_h - op.pad_h, x0 = ox * op.stride_w - op.pad_w;
+            for (int ic = 0; ic < op.in_c; ic++) {
+                for (int m = 0; m < op.depth_mult; m++) {
+                    const int oc = m + ic * op.depth_mult;
+                    int32_t acc = 0;
+                    for (int fy = 0; fy < op.k_h; fy++) {
+                        const int iy = y0 + op.dil_h * fy;
+                        for (int fx = 0; fx < op.k_w; fx++) {
+                            const int ix = x0 + op.dil_w * fx;
+                            if (iy < 0 || iy >= op.in_h || ix < 0 || ix >= op.in_w) continue;
+                            int32_t xv = in[(static_cast<size_t>(iy) * op.in_w + ix) * op.in_c + ic];
+                            int32_t wv = op.filter[(static_cast<size_t>(fy) * op.k_w + fx) * op.out_c + oc];
+                            acc += wv * (xv - op.in_zp);
+                        }
+                    }
+                    acc = mbqm(acc + op.bias[oc], op.mult[oc], op.shift[oc]) + op.out_zp;
+                    out[(static_cast<size_t>(oy) * op.out_w + ox) * op.out_c + oc] =
+                        static_cast<int8_t>(std::min(op.act_max, std::max(op.act_min, acc)));
+                }
+            }
+        }
+    }
+}
+
+// reference_ops::Mean / QuantizedMeanOrSum (média) nos eixos 1 e 2
+void mean(const Op& op, const int8_t* in, int8_t* out) {
+    for (int c = 0; c < op.in_c; c++) {
+        int32_t sum = 0;
+        for (int i = 0; i < op.mean_n; i++) sum += in[static_cast<size_t>(i) * op.in_c + c];
+        if (op.mean_plain) {
+            out[c] = static_cast<int8_t>(sum / op.mean_n);
+            continue;
+        }
+        const float mean = static_cast<float>(sum) / static_cast<float>(op.mean_n);
+        float v = std::min(std::round(mean * op.mean_scale + op.mean_bias) + op.out_zp, 127.0f);
+        out[c] = static_cast<int8_t>(std::max(v, -128.0f));
+    }
+}
+
+// reference_ops::Softmax int8 -> int8 (exp e recíproco em ponto fixo do gemmlowp)
+void softmax(const Op& op, const int8_t* in, int8_t* out, size_t n) {
+    const int depth = op.in_c;
+    for (size_t r = 0; r + depth <= n; r += depth, in += depth, out += depth) {
+        int8_t mx = *std::max_element(in, in + depth);
+        int32_t sum_of_exps = 0;  // 12 bits inteiros
+        for (int c = 0; c < depth; c++) {
+            int32_t diff = in[c] - mx;
+            if (diff >= op.diff_min) {
+                int32_t scaled = srdhm(diff * (1 << op.sm_shift), op.sm_mult);
+                sum_of_exps += rdpot(exp_on_negative_values(scaled), 12);
+            }
+        }
+        const int headroom_plus_one = count_leading_zeros(static_cast<uint32_t>(sum_of_exps));
+        const int num_bits_over_unit = 12 - headroom_plus_one;
+        const int32_t shifted_sum_minus_one = static_cast<int32_t>((static_cast<uint32_t>(sum_of_exps) << headroom_plus_one) - (static_cast<uint32_t>(1) << 31));
+        const int32_t shifted_scale = one_over_one_plus_x_for_x_in_0_1(shifted_sum_minus_one);
+        for (int c = 0; c < depth; c++) {
+            int32_t diff = in[c] - mx;
+            if (diff < op.diff_min) {
+                out[c] = -128;
+                continue;
+            }
+            int32_t scaled = srdhm(diff * (1 << op.sm_shift), op.sm_mult);
+            int32_t e = exp_on_negative_values(scaled);
+            int32_t v = rdpot(srdhm(shifted_scale, e), num_bits_over_unit + 31 - 8) - 128;
+            out[c] = static_cast<int8_t>(std::min(127, std::max(-128, v)));
+        }
+    }
+}
+
+}  // namespace
+
+void TfliteEngine::run(Workspace& ws, const int8_t* input, int8_t* output) const {
+    auto data = [&](int t) -> const int8_t* { return t == input_ ? input : ws.t[t].data(); };
+    int16_t* x = ws.window.data();
+    int32_t* acc = ws.acc.data();
+#if ENGINE_X86
+    const bool vec = vector_;
+#else
+    const bool vec = false;
+#endif
+    auto gemv_requant = [&](const Op& op, int8_t* out) {
+#if ENGINE_X86
+        if (vec) {
+            gemv_avx2(op, x, acc);
+            requant_avx2(op, acc, out);
+            return;
+        }
+#endif
+        gemv_scalar(op, x, acc);
+        requant_scalar(op, acc, out);
+    };
+    (void)vec;
+
+    for (const Op& op : ops_) {
+        const int8_t* in = data(op.in[0]);
+        int8_t* out = ws.t[op.out[0]].data();
+        switch (op.code) {
+        case OP_CONV_2D:
+            pad_input(op, in, ws.padded.data());
+            for (int oy = 0; oy < op.out_h; oy++) {
+                for (int ox = 0; ox < op.out_w; ox++, out += op.out_c) {
+                    gather_window(op, ws.padded.data(), oy, ox, x);
+                    gemv_requant(op, out);
+                }
+            }
+            break;
+        case OP_FULLY_CONNECTED:
+            for (int i = 0; i < op.k; i++) x[i] = in[i];
+            gemv_requant(op, out);
+            break;
+        case OP_DEPTHWISE_CONV_2D:
+            depthwise(op, in, out);
+            break;
+        case OP_MEAN:
+            mean(op, in, out);
+            break;
+        case OP_SOFTMAX:
+            softmax(op, in, out, ws.t[op.out[0]].size());
+            break;
+        case OP_RESHAPE:
+            std::memcpy(out, in, ws.t[op.out[0]].size());
+            break;
+        }
+    }
+    std::memcpy(output, data(output_), tensors_[output_].elements());
+}
@@ -0,0 +1,61 @@
+#pragma once
+// Motor int8 pro host: lê o .tflite direto (flatbuffer, sem a lib do TFLite) e roda o
+// grafo com a mesma aritmética dos kernels de referência do TFLM (ponto fixo do
+// gemmlowp; o MEAN em float, na mesma ordem), então os logits saem iguais aos do
+// device byte a byte. Feito pra pontuar datasets inteiros
+// fora do device: AVX2 quando a CPU tem (acumulação com madd em int16, requantização
+// em 8 canais por vez), C++ puro quando não, e uma Workspace por thread.
+//
+// Ops: CONV_2D, DEPTHWISE_CONV_2D, FULLY_CONNECTED, MEAN, SOFTMAX, RESHAPE, todas int8
+// com pesos simétricos (por canal ou por tensor); o resto é recusado no load
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TfliteEngine {
+public:
+    // Buffers dos tensores intermediários de uma thread
+    struct Workspace {
+        std::vector<std::vector<int8_t>> t;  // um por tensor não constante
+        std::vector<int16_t> padded;         // entrada da conv em int16, já com o padding
+        std::vector<int16_t> window;         // janela de uma saída da conv (k arredondado pra par)
+        std::vector<int32_t> acc;            // acumuladores de uma saída (canais arredondados pra 8)
+    };
+
+    TfliteEngine();
+    ~TfliteEngine();
+
+    // Carrega e prepara o modelo; em erro devolve false e a mensagem em error()
+    bool load(const std::string& path);
+    bool load(const uint8_t* data, size_t size);
+    const std::string& error() const { return error_; }
+
+    // false = força o caminho escalar (pra comparar com o AVX2)
+    void set_vector(bool on) { vector_ = on && avx2_; }
+    bool vector() const { return vector_; }
+
+    int input_bytes() const;   // 784 pro modelo padrão
+    int output_bytes() const;  // 10
+    float input_scale() const;
+    int input_zero_point() const;
+    float output_scale() const;
+    int output_zero_point() const;
+
+    std::unique_ptr<Workspace> make_workspace() const;
+    // Uma amostra: input int8[input_bytes()] já quantizado -> output int8[output_bytes()]
+    void run(Workspace& ws, const int8_t* input, int8_t* output) const;
+
+    struct Tensor;
+    struct Op;
+private:
+    bool fail(const std::string& msg);
+    bool prepare();
+
+    std::vector<uint8_t> file_;
+    std::vector<Tensor> tensors_;
+    std::vector<Op> ops_;
+    int input_ = -1, output_ = -1;
+    bool avx2_ = false, vector_ = false;
+    std::string error_;
+};
@@ -0,0 +1,335 @@
+// Avaliação de um dataset com o tflm_wrapper de verdade (TFLM compilado pro host), um
+// contexto por thread: mesmo código e mesmos kernels do device, sem device. O CSV é
+// lido em streaming por uma thread, em blocos que passam por filas sem lock (MPMC
+// limitadas) até as threads de inferência e voltam pra principal, que grava os
+// logits na ordem do arquivo e devolve o bloco pra leitura
+//   tflm_eval <dataset.csv> [opções]
+// Saída: 0 ok, 2 uso/arquivos/modelo
+#include "mnist_dataset.h"
+#include "mnist_kernels.h"
+#include "eval_stats.h"
+#include "tflm_wrapper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef CNN_MODEL_HEADER
+#define CNN_MODEL_HEADER "mnist_cnn_int8_model_v1.h"
+#endif
+#include CNN_MODEL_HEADER
+
+using Clock = std::chrono::steady_clock;
+
+// tflm_conv.cpp cronometra as convs pelo relógio do SDK (o sim_pico.c não entra aqui)
+extern "C" uint64_t time_us_64(void) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count());
+}
+
+struct Options {
+    std::string dataset;
+    std::string model;   // .tflite; vazio = o embutido no firmware
+    std::string logits;  // label,l0..l9 por amostra, na ordem do dataset
+    int threads = 0;     // 0 = hardware_concurrency
+    int arena_kb = 0;    // 0 = TFLM_ARENA_SIZE
+};
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "uso: %s <dataset.csv> [opções]\n"
+        "  --model ARQ      .tflite no lugar do modelo embutido\n"
+        "  --threads N      threads de inferência, um contexto cada (padrão: todos os núcleos)\n"
+        "  --arena-kb N     arena de cada contexto (padrão: a do firmware)\n"
+        "  --logits ARQ     grava label,l0..l9 por amostra (formato do --ref-logits)\n",
+        argv0);
+}
+
+static bool parse_args(int argc, char** argv, Options& o) {
+    std::vector<std::string> pos;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* v = nullptr;
+        if (a == "--model" && (v = next())) o.model = v;
+        else if (a == "--threads" && (v = next())) o.threads = std::max(0, std::atoi(v));
+        else if (a == "--arena-kb" && (v = next())) o.arena_kb = std::max(0, std::atoi(v));
+        else if (a == "--logits" && (v = next())) o.logits = v;
+        else if (a.rfind("--", 0) == 0) return false;
+        else pos.push_back(a);
+    }
+    if (pos.size() != 1) return false;
+    o.dataset = pos[0];
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Fila MPMC limitada (Vyukov): cada célula tem um número de sequência que diz se está
+// livre pra escrita (seq == pos) ou com dado pra leitura (seq == pos + 1); push e pop
+// só disputam um CAS na posição, sem lock nem alocação
+
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity) : mask_(capacity - 1), cells_(capacity) {
+        for (size_t i = 0; i < capacity; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool try_push(T v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const size_t seq = c.seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = v;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;  // cheia
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& v) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const size_t seq = c.seq.load(std::memory_order_acquire);
+            const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    v = c.value;
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;  // vazia
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Versões que esperam: cede o núcleo enquanto a outra ponta não anda
+    void push(T v) {
+        while (!try_push(v)) std::this_thread::yield();
+    }
+    T pop() {
+        T v;
+        while (!try_pop(v)) std::this_thread::yield();
+        return v;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    const size_t mask_;
+    std::vector<Cell> cells_;
+    alignas(64) std::atomic<size_t> head_{0};  // linhas de cache separadas pra produtor e consumidor
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// Bloco de amostras consecutivas do dataset; count == 0 manda a thread de inferência parar
+struct Block {
+    static constexpr int kSamples = 64;
+    size_t first = 0;
+    int count = 0;
+    MnistSample samples[kSamples];
+    int8_t logits[kSamples][EVAL_CLASSES];
+};
+
+static size_t pow2_at_least(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static bool read_file(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    out.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Uma thread de inferência: o contexto é só dela, a matriz de confusão também
+static void infer(tflm_ctx_t* ctx, MpmcQueue<Block*>& todo, MpmcQueue<Block*>& done, eval_stats_t* ev) {
+    int8_t lut[256];
+    build_input_lut(lut, tflm_ctx_input_scale(ctx), tflm_ctx_input_zero_point(ctx));
+    const int batch = tflm_ctx_batch_size(ctx);
+    int8_t* in = tflm_ctx_input(ctx, nullptr);
+    const int8_t* out = tflm_ctx_output(ctx, nullptr);
+    eval_reset(ev);
+    for (;;) {
+        Block* b = todo.pop();
+        if (b->count == 0) break;
+        for (int k = 0; k < b->count; k += batch) {
+            const int n = std::min(batch, b->count - k);
+            for (int j = 0; j < n; j++) {
+                const uint8_t* px = b->samples[k + j].pixels.data();
+                for (int i = 0; i < 784; i++) in[j * 784 + i] = lut[px[i]];
+            }
+            if (tflm_ctx_invoke(ctx) != 0) std::fprintf(stderr, "erro: invoke falhou no bloco %zu\n", b->first);
+            for (int j = 0; j < n; j++) {
+                std::copy(out + j * EVAL_CLASSES, out + (j + 1) * EVAL_CLASSES, b->logits[k + j]);
+                eval_add(ev, b->samples[k + j].label, argmax_i8(b->logits[k + j], EVAL_CLASSES), 0);
+            }
+        }
+        done.push(b);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // O flatbuffer precisa ficar alinhado e vivo enquanto os contextos existirem
+    const uint8_t* model = mnist_cnn_int8_model;
+    std::unique_ptr<uint64_t[]> model_buf;
+    if (!opt.model.empty()) {
+        std::vector<uint8_t> raw;
+        if (!read_file(opt.model, raw) || tflm_model_check(raw.data(), static_cast<uint32_t>(raw.size())) != 0) {
+            std::fprintf(stderr, "erro: %s não é um modelo válido\n", opt.model.c_str());
+            return 2;
+        }
+        model_buf.reset(new uint64_t[(raw.size() + 7) / 8]);
+        std::copy(raw.begin(), raw.end(), reinterpret_cast<uint8_t*>(model_buf.get()));
+        model = reinterpret_cast<const uint8_t*>(model_buf.get());
+    }
+
+    MnistCsvReader reader;
+    if (!reader.open(opt.dataset)) {
+        std::fprintf(stderr, "erro: nao consegui abrir %s\n", opt.dataset.c_str());
+        return 2;
+    }
+    std::ofstream lg;
+    if (!opt.logits.empty()) {
+        lg.open(opt.logits);
+        if (!lg) {
+            std::fprintf(stderr, "erro: nao consegui gravar %s\n", opt.logits.c_str());
+            return 2;
+        }
+    }
+
+    // Contextos criados aqui, em série (registrar as ops não é thread-safe); cada um
+    // com sua arena, alinhada em 16 pelo próprio tflm_ctx_create
+    const int threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    const int arena_size = opt.arena_kb ? opt.arena_kb * 1024 : TFLM_ARENA_SIZE;
+    std::vector<std::unique_ptr<uint8_t[]>> arenas;
+    std::vector<tflm_ctx_t*> ctxs;
+    for (int t = 0; t < threads; t++) {
+        arenas.emplace_back(new uint8_t[arena_size]);
+        tflm_ctx_t* ctx = tflm_ctx_create(model, arenas.back().get(), arena_size);
+        if (!ctx) {
+            std::fprintf(stderr, "erro: contexto %d não montou (arena de %d bytes)\n", t, arena_size);
+            return 2;
+        }
+        ctxs.push_back(ctx);
+    }
+
+    // Blocos suficientes pra leitura, inferência e escrita andarem juntas
+    const size_t n_blocks = static_cast<size_t>(threads) * 4;
+    std::vector<std::unique_ptr<Block>> blocks;
+    MpmcQueue<Block*> free_q(pow2_at_least(n_blocks + threads)), todo(pow2_at_least(n_blocks + threads)),
+        done(pow2_at_least(n_blocks));
+    for (size_t i = 0; i < n_blocks; i++) {
+        blocks.emplace_back(new Block);
+        free_q.push(blocks.back().get());
+    }
+    Block stop;  // count == 0
+
+    std::atomic<size_t> n_read{0};
+    std::atomic<bool> eof{false};
+    std::thread producer([&] {
+        size_t first = 0;
+        for (bool more = true; more;) {
+            Block* b = free_q.pop();
+            b->first = first;
+            b->count = 0;
+            while (b->count < Block::kSamples && (more = reader.next(b->samples[b->count]))) b->count++;
+            if (b->count == 0) {
+                free_q.push(b);
+                break;
+            }
+            first += static_cast<size_t>(b->count);
+            n_read.store(first, std::memory_order_release);
+            todo.push(b);
+        }
+        eof.store(true, std::memory_order_release);
+        for (int t = 0; t < threads; t++) todo.push(&stop);
+    });
+
+    const auto t0 = Clock::now();
+    std::vector<eval_stats_t> ev(static_cast<size_t>(threads));
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(infer, ctxs[t], std::ref(todo), std::ref(done), &ev[t]);
+
+    // Os blocos chegam fora de ordem; os adiantados esperam no mapa até a vez deles
+    std::map<size_t, Block*> pending;
+    size_t written = 0;
+    for (;;) {
+        if (eof.load(std::memory_order_acquire) && written == n_read.load(std::memory_order_acquire)) break;
+        Block* b;
+        if (!done.try_pop(b)) {
+            std::this_thread::yield();
+            continue;
+        }
+        pending[b->first] = b;
+        for (auto it = pending.begin(); it != pending.end() && it->first == written; it = pending.erase(it)) {
+            Block* r = it->second;
+            for (int k = 0; lg.is_open() && k < r->count; k++) {
+                lg << int(r->samples[k].label);
+                for (int i = 0; i < EVAL_CLASSES; i++) lg << ',' << int(r->logits[k][i]);
+                lg << '\n';
+            }
+            written += static_cast<size_t>(r->count);
+            free_q.push(r);
+        }
+    }
+    producer.join();
+    for (std::thread& th : pool) th.join();
+    const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    if (reader.bad_lines()) std::fprintf(stderr, "aviso: %zu linhas malformadas ignoradas\n", reader.bad_lines());
+    if (written == 0) {
+        std::fprintf(stderr, "erro: %s sem amostras\n", opt.dataset.c_str());
+        return 2;
+    }
+
+    eval_stats_t all;
+    eval_reset(&all);
+    for (const eval_stats_t& e : ev) {
+        for (int r = 0; r < EVAL_CLASSES; r++)
+            for (int c = 0; c < EVAL_CLASSES; c++) all.cm[r][c] += e.cm[r][c];
+        all.total += e.total;
+        all.correct += e.correct;
+    }
+    all.first_us = 0;
+    all.last_us = static_cast<uint32_t>(std::min(secs * 1e6, 4e9));
+
+    std::printf("modelo:   %s, arena %d bytes (usados %d), batch %d\n", opt.model.empty() ? "embutido" : opt.model.c_str(),
+                arena_size, tflm_ctx_arena_used_bytes(ctxs[0]), tflm_ctx_batch_size(ctxs[0]));
+    std::printf("amostras: %zu, %d threads, %.3f s\n", written, threads, secs);
+    std::printf("vazao:    %.0f imagens/s\n", static_cast<double>(written) / secs);
+    std::printf("acuracia: %.2f%% (%u/%u)\n", 100.0 * all.correct / std::max<uint32_t>(all.total, 1), all.correct, all.total);
+    eval_dump(&all);
+    for (tflm_ctx_t* ctx : ctxs) tflm_ctx_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Converte o dump binário do trace ($TRACE) em JSON do Chrome/Perfetto
+// (abrir em chrome://tracing ou ui.perfetto.dev)
+//   trace2json captura.bin [-o trace.json]        a partir de uma captura da serial
+//   trace2json --device /dev/ttyACM0 [-o ...]     pede o dump direto ao device
+#include "serial_link.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Fonte do dump: captura em arquivo ou device ao vivo
+class DumpSource {
+public:
+    virtual ~DumpSource() = default;
+    virtual bool line(std::string& out) = 0;
+    virtual bool bytes(std::string& out, size_t n) = 0;
+};
+
+class FileSource : public DumpSource {
+public:
+    explicit FileSource(std::string data) : data_(std::move(data)) {}
+    bool line(std::string& out) override {
+        while (pos_ < data_.size()) {
+            size_t nl = data_.find('\n', pos_);
+            if (nl == std::string::npos) nl = data_.size();
+            out.assign(data_, pos_, nl - pos_);
+            pos_ = nl + 1;
+            if (!out.empty() && out.back() == '\r') out.pop_back();
+            if (!out.empty()) return true;
+        }
+        return false;
+    }
+    bool bytes(std::string& out, size_t n) override {
+        if (data_.size() - pos_ < n) return false;
+        out.assign(data_, pos_, n);
+        pos_ += n;
+        return true;
+    }
+private:
+    std::string data_;
+    size_t pos_ = 0;
+};
+
+class DeviceSource : public DumpSource {
+public:
+    explicit DeviceSource(SerialLink& link) : link_(link) {}
+    bool line(std::string& out) override { return link_.read_line(out, 3000); }
+    bool bytes(std::string& out, size_t n) override { return link_.read_bytes(out, n, 3000); }
+private:
+    SerialLink& link_;
+};
+
+static std::string json_escape(const std::string& s) {
+    std::string o;
+    for (char c : s) {
+        if (c == '"' || c == '\\') o += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) o += c;
+    }
+    return o;
+}
+
+int main(int argc, char** argv) {
+    std::string input, device, output;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--device" && i + 1 < argc) device = argv[++i];
+        else if (a == "-o" && i + 1 < argc) output = argv[++i];
+        else if (a[0] != '-' && input.empty()) input = a;
+        else {
+            std::fprintf(stderr, "uso: %s <captura.bin | --device porta> [-o trace.json]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (input.empty() == device.empty()) {
+        std::fprintf(stderr, "uso: %s <captura.bin | --device porta> [-o trace.json]\n", argv[0]);
+        return 2;
+    }
+
+    SerialLink link;
+    std::unique_ptr<DumpSource> src;
+    if (!device.empty()) {
+        if (!link.open(device, 0)) {
+            std::fprintf(stderr, "erro: nao consegui abrir %s\n", device.c_str());
+            return 1;
+        }
+        link.write_line("$TRACE");
+        src = std::make_unique<DeviceSource>(link);
+    } else {
+        std::ifstream f(input, std::ios::binary);
+        if (!f) {
+            std::fprintf(stderr, "erro: nao consegui abrir %s\n", input.c_str());
+            return 1;
+        }
+        src = std::make_unique<FileSource>(std::string(std::istreambuf_iterator<char>(f), {}));
+    }
+
+    // Cabeçalho T,<eventos>,<nomes>,<perdidos> (ignora o que vier antes)
+    std::string line;
+    unsigned long count = 0, nnames = 0, dropped = 0;
+    for (;;) {
+        if (!src->line(line)) {
+            std::fprintf(stderr, "erro: cabecalho T,<eventos>,... nao encontrado\n");
+            return 1;
+        }
+        if (std::sscanf(line.c_str(), "T,%lu,%lu,%lu", &count, &nnames, &dropped) == 3) break;
+    }
+    std::map<int, std::string> names;
+    for (unsigned long i = 0; i < nnames; i++) {
+        int id = 0;
+        char name[64] = {0};
+        if (!src->line(line) || std::sscanf(line.c_str(), "G,%d,%63[^\n]", &id, name) != 2) {
+            std::fprintf(stderr, "erro: tabela de nomes incompleta\n");
+            return 1;
+        }
+        names[id] = name;
+    }
+    std::string raw;
+    if (!src->bytes(raw, count * sizeof(trace_event_t))) {
+        std::fprintf(stderr, "erro: bloco binario truncado (%lu eventos esperados)\n", count);
+        return 1;
+    }
+    if (!src->line(line) || line != "T,END") std::fprintf(stderr, "aviso: terminador T,END ausente\n");
+
+    // Decodifica, desfaz o wrap de 32 bits do timer por núcleo e casa begin/end
+    struct Ev { uint64_t ts; int event; char phase; int core; int arg; };
+    std::vector<Ev> evs;
+    uint64_t base[2] = {0, 0};
+    uint32_t last[2] = {0, 0};
+    bool seen[2] = {false, false};
+    std::map<std::pair<int, int>, int> open;  // (núcleo, evento) -> begins abertos
+    for (unsigned long i = 0; i < count; i++) {
+        const auto* r = reinterpret_cast<const unsigned char*>(raw.data() + i * 8);
+        uint32_t ts = static_cast<uint32_t>(r[0]) | (static_cast<uint32_t>(r[1]) << 8) |
+                      (static_cast<uint32_t>(r[2]) << 16) | (static_cast<uint32_t>(r[3]) << 24);
+        int core = r[6] & 1;
+        if (seen[core] && ts < last[core] && last[core] - ts > 0x80000000u) base[core] += 0x100000000ull;
+        seen[core] = true;
+        last[core] = ts;
+        Ev e{base[core] + ts, r[4], static_cast<char>(r[5]), core, r[7]};
+        auto key = std::make_pair(core, e.event);
+        if (e.phase == TRACE_PHASE_END) {
+            if (open[key] == 0) continue;  // o begin já saiu do ring
+            open[key]--;
+        } else {
+            open[key]++;
+        }
+        evs.push_back(e);
+    }
+    // Spans medidos depois (ex.: rx) entram no ring fora de ordem; o viewer quer ordem temporal
+    std::stable_sort(evs.begin(), evs.end(), [](const Ev& a, const Ev& b) { return a.ts < b.ts; });
+    const uint64_t t0 = evs.empty() ? 0 : evs.front().ts;
+
+    std::ostringstream js;
+    js << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    js << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"core0\"}},\n";
+    js << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"core1\"}}";
+    for (const auto& e : evs) {
+        auto it = names.find(e.event);
+        std::string name = (it != names.end()) ? it->second : "evento_" + std::to_string(e.event);
+        js << ",\n{\"name\":\"" << json_escape(name) << "\",\"cat\":\""
+           << (e.event >= TRACE_OP_BASE ? "tflm" : "firmware") << "\",\"ph\":\"" << e.phase
+           << "\",\"ts\":" << (e.ts - t0) << ",\"pid\":1,\"tid\":" << e.core;
+        if (e.event >= TRACE_OP_BASE) js << ",\"args\":{\"op\":" << e.arg << "}";
+        js << "}";
+    }
+    js << "\n]}\n";
+
+    if (output.empty()) {
+        std::fputs(js.str().c_str(), stdout);
+    } else {
+        std::ofstream(output) << js.str();
+    }
+    std::fprintf(stderr, "%zu eventos convertidos (%lu no dump, %lu sobrescritos no ring)\n",
+                 evs.size(), count, dropped);
+    return 0;
+}
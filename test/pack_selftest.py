@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Empacota amostras rotuladas pro autoteste do firmware (selftest.c).
+
+Lê um CSV no formato de mnist_test_samples.txt (label,p1..p784) ou imagens IDX do
+MNIST (com --labels) e gera um header C com as amostras comprimidas, que vai pra
+flash junto com o firmware. Formato de cada amostra: um byte de label e tokens até
+completar 784 pixels:
+  0x00..0x7F  corrida de 1..128 zeros
+  0x80..0xFF  1..128 pixels literais logo em seguida
+Sem perda: o autoteste vê exatamente os pixels do arquivo.
+
+Com --logits (label,l0..l9 por amostra: mnist_score/tflm_eval --logits, ou os do
+notebook) o header leva o CRC-32 dos logits esperados e o device responde OK/FALHA.
+
+  pack_selftest.py <dados> <saida.h> [--labels ARQ] [--count N] [--logits ARQ]
+"""
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+PIXELS = 784
+
+
+def read_csv(path):
+    samples = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            v = [int(x) for x in line.replace('\t', ',').split(',') if x.strip()]
+            if len(v) != PIXELS + 1 or not 0 <= v[0] <= 9 or any(not 0 <= p <= 255 for p in v[1:]):
+                sys.exit(f'{path}: linha malformada: {line[:40]}...')
+            samples.append((v[0], bytes(v[1:])))
+    return samples
+
+
+def read_idx(images, labels):
+    with open(images, 'rb') as f:
+        img = f.read()
+    magic, n, rows, cols = struct.unpack('>IIII', img[:16])
+    if magic != 0x803 or rows != 28 or cols != 28:
+        sys.exit(f'{images}: não é IDX de imagens 28x28')
+    if not labels:
+        sys.exit('imagens IDX precisam de --labels')
+    with open(labels, 'rb') as f:
+        lab = f.read()
+    if struct.unpack('>II', lab[:8]) != (0x801, n):
+        sys.exit(f'{labels}: não bate com {images}')
+    return [(lab[8 + k], img[16 + k * PIXELS:16 + (k + 1) * PIXELS]) for k in range(n)]
+
+
+def is_idx(path):
+    with open(path, 'rb') as f:
+        return f.read(4) == b'\x00\x00\x08\x03'
+
+
+def encode(pixels):
+    out = bytearray()
+    i = 0
+    while i < PIXELS:
+        if pixels[i] == 0:
+            j = i
+            while j < PIXELS and j - i < 128 and pixels[j] == 0:
+                j += 1
+            out.append(j - i - 1)
+        else:
+            # Literais até o próximo par de zeros (um zero solto sai mais barato como literal)
+            j = i
+            while j < PIXELS and j - i < 128 and not (pixels[j] == 0 and (j + 1 == PIXELS or pixels[j + 1] == 0)):
+                j += 1
+            out.append(0x7F + (j - i))
+            out += pixels[i:j]
+        i = j
+    return out
+
+
+def decode(data, pos):
+    label = data[pos]
+    pos += 1
+    pixels = bytearray()
+    while len(pixels) < PIXELS:
+        b = data[pos]
+        pos += 1
+        if b < 0x80:
+            pixels += bytes(b + 1)
+        else:
+            n = b - 0x7F
+            pixels += data[pos:pos + n]
+            pos += n
+    assert len(pixels) == PIXELS
+    return label, bytes(pixels), pos
+
+
+def read_logits(path, count):
+    crc = 0
+    n = 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            v = [int(x) for x in line.split(',')]
+            crc = zlib.crc32(bytes(x & 0xFF for x in v[1:]), crc)
+            n += 1
+            if n == count:
+                break
+    if n < count:
+        sys.exit(f'{path}: só {n} linhas de logits pra {count} amostras')
+    return crc
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument('data')
+    ap.add_argument('output')
+    ap.add_argument('--labels', default='')
+    ap.add_argument('--count', type=int, default=0, help='quantas amostras (0 = todas)')
+    ap.add_argument('--logits', default='')
+    a = ap.parse_args()
+
+    samples = read_idx(a.data, a.labels) if is_idx(a.data) else read_csv(a.data)
+    if a.count > 0:
+        samples = samples[:a.count]
+    if not samples:
+        sys.exit(f'{a.data}: sem amostras')
+
+    blob = bytearray()
+    for label, pixels in samples:
+        blob.append(label)
+        blob += encode(pixels)
+    # Confere o próprio formato antes de gravar
+    pos = 0
+    for label, pixels in samples:
+        l, p, pos = decode(blob, pos)
+        assert (l, p) == (label, pixels)
+    crc = read_logits(a.logits, len(samples)) if a.logits else 0
+
+    os.makedirs(os.path.dirname(os.path.abspath(a.output)), exist_ok=True)
+    with open(a.output, 'w') as f:
+        f.write('#pragma once\n')
+        f.write(f'// Gerado por test/pack_selftest.py a partir de {os.path.basename(a.data)}, não editar\n')
+        f.write(f'// {len(samples)} amostras, {len(blob)} bytes ({len(blob) / len(samples):.1f} por amostra, '
+                f'{len(samples) * (PIXELS + 1)} sem compressão)\n')
+        f.write('#include <stdint.h>\n\n')
+        f.write(f'#define SELFTEST_COUNT {len(samples)}\n')
+        f.write(f'#define SELFTEST_LOGITS_CRC 0x{crc:08x}u  // 0 = sem logits de referência\n\n')
+        f.write(f'static const uint8_t selftest_blob[{len(blob)}] = {{\n')
+        for k in range(0, len(blob), 16):
+            f.write('  ' + ', '.join(f'0x{b:02x}' for b in blob[k:k + 16]) + ',\n')
+        f.write('};\n')
+    print(f'pack_selftest: {len(samples)} amostras, {len(blob)} bytes -> {a.output}')
+
+
+if __name__ == '__main__':
+    main()